@@ -6,12 +6,28 @@
 #include "shcoll/compat.h"
 #include "util/rotate.h"
 #include "util/scan.h"
-#include "util/broadcast-size.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <limits.h>
 #include <assert.h>
 
+static int bruck_radix_collect = 2;
+static size_t ring_segment_size_collect = 65536;
+
+void
+shcoll_set_collect_bruck_radix(int radix)
+{
+    bruck_radix_collect = radix;
+}
+
+void
+shcoll_set_collect_ring_segment_size(size_t segment_size)
+{
+    ring_segment_size_collect = segment_size;
+}
+
 inline static void
 collect_helper_linear(void *dest, const void *source, size_t nbytes,
                       int PE_start, int logPE_stride, int PE_size,
@@ -77,7 +93,7 @@ collect_helper_all_linear(void *dest, const void *source, size_t nbytes,
     int i;
     int target;
 
-    exclusive_prefix_sum(&block_offset, nbytes, PE_start, logPE_stride, PE_size, pSync + 1);
+    exclusive_prefix_sum(&block_offset, NULL, nbytes, PE_start, logPE_stride, PE_size, pSync + 1);
 
     for (i = 1; i < PE_size; i++) {
         target = PE_start + ((i + me_as) % PE_size) * stride;
@@ -114,7 +130,7 @@ collect_helper_all_linear1(void *dest, const void *source, size_t nbytes,
     int i;
     int target;
 
-    exclusive_prefix_sum(&block_offset, nbytes, PE_start, logPE_stride, PE_size, pSync + 1);
+    exclusive_prefix_sum(&block_offset, NULL, nbytes, PE_start, logPE_stride, PE_size, pSync + 1);
 
     for (i = 1; i < PE_size; i++) {
         target = PE_start + ((i + me_as) % PE_size) * stride;
@@ -149,7 +165,7 @@ collect_helper_rec_dbl(void *dest, const void *source, size_t nbytes,
 
     assert(((PE_size - 1) & PE_size) == 0);
 
-    exclusive_prefix_sum(&block_offset, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
+    exclusive_prefix_sum(&block_offset, NULL, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
 
     memcpy((char*) dest + block_offset, source, nbytes);
 
@@ -194,7 +210,7 @@ collect_helper_rec_dbl_signal(void *dest, const void *source, size_t nbytes,
 
     assert(((PE_size - 1) & PE_size) == 0);
 
-    exclusive_prefix_sum(&block_offset, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
+    exclusive_prefix_sum(&block_offset, NULL, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
 
     memcpy((char*) dest + block_offset, source, nbytes);
 
@@ -216,8 +232,178 @@ collect_helper_rec_dbl_signal(void *dest, const void *source, size_t nbytes,
 }
 
 
-/* TODO Find a better way to choose this value */
-#define RING_DIFF 10
+/*
+ * Recursive doubling for any PE_size, the PEs outside the power 2 set are
+ * folded in and out as in fcollect_helper_rec_dbl_fold.  A member and its
+ * follower have adjacent blocks, so the member starts with both of them.
+ */
+inline static void
+collect_helper_rec_dbl_fold(void *dest, const void *source, size_t nbytes,
+                            int PE_start, int logPE_stride, int PE_size,
+                            long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    int mask;
+    int peer;
+    int i;
+    int follower_as;
+    size_t round_block_size;
+    size_t block_offset;
+    size_t block_size = nbytes;
+
+    /* Power 2 set */
+    int me_p2s;
+    int p2s_size;
+
+    /* pSync */
+    long *prefix_sum_pSync = pSync;
+    size_t *block_sizes = (size_t *) (prefix_sum_pSync + PREFIX_SUM_SYNC_SIZE);
+    size_t *fold_size = block_sizes + PE_SIZE_LOG;
+
+    exclusive_prefix_sum(&block_offset, NULL, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
+
+    /* Find the greatest power of 2 lower than PE_size */
+    for (p2s_size = 1; p2s_size * 2 <= PE_size; p2s_size *= 2);
+
+    /* Check if the current PE belongs to the power 2 set */
+    me_p2s = me_as * p2s_size / PE_size;
+    if ((me_p2s * PE_size + p2s_size - 1) / p2s_size != me_as) {
+        peer = PE_start + (me_as - 1) * stride;
+
+        shmem_putmem_nbi((char*) dest + block_offset, source, nbytes, peer);
+        shmem_fence();
+        shmem_size_p(fold_size, nbytes + 1 + SHCOLL_SYNC_VALUE, peer);
+
+        /* The member sends the total size after the whole result */
+        shmem_size_wait_until(fold_size, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_size_p(fold_size, SHCOLL_SYNC_VALUE, me);
+        return;
+    }
+
+    memcpy((char*) dest + block_offset, source, nbytes);
+
+    /* There is at most one PE between two members of the power 2 set */
+    follower_as = ((me_p2s + 1) * PE_size + p2s_size - 1) / p2s_size > me_as + 1 ? me_as + 1 : -1;
+
+    if (follower_as != -1) {
+        shmem_size_wait_until(fold_size, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        block_size += *fold_size - 1 - SHCOLL_SYNC_VALUE;
+        shmem_size_p(fold_size, SHCOLL_SYNC_VALUE, me);
+    }
+
+    for (mask = 0x1, i = 0; mask < p2s_size; mask <<= 1, i++) {
+        peer = PE_start + (((me_p2s ^ mask) * PE_size + p2s_size - 1) / p2s_size) * stride;
+
+        shmem_putmem_nbi((char*) dest + block_offset, (char*) dest + block_offset, block_size, peer);
+        shmem_fence();
+        shmem_size_p(block_sizes + i, block_size + 1 + SHCOLL_SYNC_VALUE, peer);
+
+        shmem_size_wait_until(block_sizes + i, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        round_block_size = *(block_sizes + i) - 1 - SHCOLL_SYNC_VALUE;
+        shmem_size_p(block_sizes + i, SHCOLL_SYNC_VALUE, me);
+
+        if (me > peer) {
+            block_offset -= round_block_size;
+        }
+        block_size += round_block_size;
+    }
+
+    if (follower_as != -1) {
+        peer = PE_start + follower_as * stride;
+
+        shmem_putmem_nbi(dest, dest, block_size, peer);
+        shmem_fence();
+        shmem_size_p(fold_size, block_size + 1 + SHCOLL_SYNC_VALUE, peer);
+    }
+}
+
+/*
+ * Recursive doubling without the prefix sum: the group gathered so far is
+ * always kept at the beginning of dest in PE order.  The PE of the upper
+ * group moves its data up by the size of the lower group, which it gets in
+ * the signal, and both PEs then read the other half from the peer.
+ */
+inline static void
+collect_helper_rec_dbl_no_scan(void *dest, const void *source, size_t nbytes,
+                               int PE_start, int logPE_stride, int PE_size,
+                               long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    int mask;
+    int peer;
+    int i;
+    size_t round_block_size;
+    size_t block_size = nbytes;
+
+    /* pSync */
+    size_t *block_sizes = (size_t *) pSync;
+    long *acks = pSync + PE_SIZE_LOG;
+
+    assert(((PE_size - 1) & PE_size) == 0);
+
+    memcpy(dest, source, nbytes);
+
+    for (mask = 0x1, i = 0; mask < PE_size; mask <<= 1, i++) {
+        peer = PE_start + (me_as ^ mask) * stride;
+
+        if (me < peer) {
+            shmem_size_atomic_set(block_sizes + i, block_size + 1 + SHCOLL_SYNC_VALUE, peer);
+
+            shmem_size_wait_until(block_sizes + i, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+            round_block_size = *(block_sizes + i) - 1 - SHCOLL_SYNC_VALUE;
+            shmem_size_p(block_sizes + i, SHCOLL_SYNC_VALUE, me);
+
+            /* The peer has already moved its data after mine */
+            shmem_getmem((char *) dest + block_size, (char *) dest + block_size, round_block_size, peer);
+        } else {
+            shmem_size_wait_until(block_sizes + i, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+            round_block_size = *(block_sizes + i) - 1 - SHCOLL_SYNC_VALUE;
+            shmem_size_p(block_sizes + i, SHCOLL_SYNC_VALUE, me);
+
+            memmove((char *) dest + round_block_size, dest, block_size);
+            shmem_size_atomic_set(block_sizes + i, block_size + 1 + SHCOLL_SYNC_VALUE, peer);
+
+            shmem_getmem(dest, dest, round_block_size, peer);
+        }
+
+        /* The data can be moved in the next round only after the peer has read it */
+        shmem_long_atomic_inc(acks + i, peer);
+        shmem_long_wait_until(acks + i, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(acks + i, SHCOLL_SYNC_VALUE, me);
+
+        block_size += round_block_size;
+    }
+}
+
+
+/*
+ * The ring algorithms receive the block sizes in a window of pSync slots, the
+ * sender may get as many rounds ahead of the receiver as there are slots.  The
+ * window is as large as pSync allows, but not larger than the number of
+ * rounds, so that short rings never wait for a free slot.  A PE returns only
+ * when the receiver has read all its sizes, so every call starts with an empty
+ * window in slot 0.
+ */
+#define RING_MAX_DIFF (SHCOLL_COLLECT_SYNC_SIZE - 1 - PREFIX_SUM_SYNC_SIZE)
+#define BIDIR_RING_MAX_DIFF ((SHCOLL_COLLECT_SYNC_SIZE - 2 - PREFIX_SUM_SYNC_SIZE) / 2)
+
+inline static int
+ring_diff(int nrounds, int max_diff)
+{
+    if (nrounds < 1) {
+        return 1;
+    }
+
+    return nrounds < max_diff ? nrounds : max_diff;
+}
 
 inline static void
 collect_helper_ring(void *dest, const void *source, size_t nbytes,
@@ -226,8 +412,8 @@ collect_helper_ring(void *dest, const void *source, size_t nbytes,
 {
     /*
      * pSync[0] is to track the progress of the left PE
-     * pSync[1..RING_DIFF] is used to receive block sizes
-     * pSync[RING_DIFF..] is used for exclusive prefix sum
+     * pSync[1..1+RING_MAX_DIFF) is used to receive block sizes
+     * pSync[1+RING_MAX_DIFF..] is used for exclusive prefix sum
      */
     const int stride = 1 << logPE_stride;
     const int me = shmem_my_pe();
@@ -237,6 +423,7 @@ collect_helper_ring(void *dest, const void *source, size_t nbytes,
     int send_to_pe = PE_start + ((me_as - 1 + PE_size) % PE_size) * stride;
 
     int round;
+    const int diff = ring_diff(PE_size - 1, RING_MAX_DIFF);
     long *receiver_progress = pSync;
     size_t *block_sizes = (size_t *) (pSync + 1);
     size_t *block_size_round;
@@ -244,7 +431,7 @@ collect_helper_ring(void *dest, const void *source, size_t nbytes,
 
     size_t block_offset;
 
-    exclusive_prefix_sum(&block_offset, nbytes, PE_start, logPE_stride, PE_size, pSync + 1 + RING_DIFF);
+    exclusive_prefix_sum(&block_offset, NULL, nbytes, PE_start, logPE_stride, PE_size, pSync + 1 + RING_MAX_DIFF);
 
     memcpy(((char *) dest) + block_offset, source, nbytes_round);
 
@@ -254,8 +441,8 @@ collect_helper_ring(void *dest, const void *source, size_t nbytes,
         shmem_fence();
 
         /* Wait until it's safe to use block_size buffer */
-        shmem_long_wait_until(receiver_progress, SHMEM_CMP_GT, round - RING_DIFF + SHCOLL_SYNC_VALUE);
-        block_size_round = block_sizes + (round % RING_DIFF);
+        shmem_long_wait_until(receiver_progress, SHMEM_CMP_GT, round - diff + SHCOLL_SYNC_VALUE);
+        block_size_round = block_sizes + (round % diff);
 
         // TODO: fix -> shmem_size_p(block_size_round, nbytes_round + 1 + SHCOLL_SYNC_VALUE, send_to_pe);
         shmem_size_atomic_set(block_size_round, nbytes_round + 1 + SHCOLL_SYNC_VALUE, send_to_pe);
@@ -275,8 +462,272 @@ collect_helper_ring(void *dest, const void *source, size_t nbytes,
         shmem_long_atomic_inc(receiver_progress, recv_from_pe);
     }
 
-    /* Must be atomic fadd because there may be some PE that did not finish with sends */
-    shmem_long_atomic_add(receiver_progress, -round, me);
+    /* The left PE must have read all the sizes before the window is reused */
+    shmem_long_wait_until(receiver_progress, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + round);
+    shmem_long_p(receiver_progress, SHCOLL_SYNC_VALUE, me);
+}
+
+/*
+ * Bidirectional ring: the blocks travel both to the right and to the left,
+ * as in fcollect_helper_bidir_ring, so both directions of every link are
+ * used and there are only ⌈(PE_size - 1) / 2⌉ rounds.  Each direction has its
+ * own progress counter and window of block sizes, as in collect_helper_ring.
+ */
+inline static void
+collect_helper_bidir_ring(void *dest, const void *source, size_t nbytes,
+                          int PE_start, int logPE_stride, int PE_size,
+                          long *pSync)
+{
+    /*
+     * pSync[0..2) track the progress of the right and of the left PE
+     * pSync[2..2+2*BIDIR_RING_MAX_DIFF) are used to receive block sizes from
+     *          the left and from the right PE
+     * pSync[2+2*BIDIR_RING_MAX_DIFF..] is used for exclusive prefix sum
+     */
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    int me_as = (me - PE_start) / stride;
+    int right_pe = PE_start + ((me_as + 1) % PE_size) * stride;
+    int left_pe = PE_start + ((me_as - 1 + PE_size) % PE_size) * stride;
+
+    /* Number of blocks that come from the left and from the right PE */
+    const int nfrom_left = PE_size / 2;
+    const int nfrom_right = (PE_size - 1) / 2;
+    const int diff = ring_diff(nfrom_left, BIDIR_RING_MAX_DIFF);
+
+    int round;
+    long *progress = pSync;
+    size_t *block_sizes[2] = {(size_t *) (pSync + 2), (size_t *) (pSync + 2 + BIDIR_RING_MAX_DIFF)};
+    size_t *block_size_round;
+
+    /* Blocks last received from the left and from the right PE */
+    int left_block = me_as;
+    int right_block = me_as;
+    size_t left_offset;
+    size_t right_offset;
+    size_t left_nbytes = nbytes;
+    size_t right_nbytes = nbytes;
+    size_t total_nbytes;
+
+    exclusive_prefix_sum(&left_offset, &total_nbytes, nbytes, PE_start, logPE_stride, PE_size,
+                         pSync + 2 + 2 * BIDIR_RING_MAX_DIFF);
+    right_offset = left_offset;
+
+    memcpy((char *) dest + left_offset, source, nbytes);
+
+    for (round = 0; round < nfrom_left; round++) {
+        /* Pass on the blocks received in the previous round */
+        shmem_putmem_nbi((char *) dest + left_offset, (char *) dest + left_offset, left_nbytes, right_pe);
+        if (round < nfrom_right) {
+            shmem_putmem_nbi((char *) dest + right_offset, (char *) dest + right_offset, right_nbytes, left_pe);
+        }
+        shmem_fence();
+
+        /* Wait until it's safe to use block_size buffers */
+        shmem_long_wait_until(progress, SHMEM_CMP_GT, round - diff + SHCOLL_SYNC_VALUE);
+        shmem_size_atomic_set(block_sizes[0] + round % diff,
+                              left_nbytes + 1 + SHCOLL_SYNC_VALUE, right_pe);
+
+        if (round < nfrom_right) {
+            shmem_long_wait_until(progress + 1, SHMEM_CMP_GT, round - diff + SHCOLL_SYNC_VALUE);
+            shmem_size_atomic_set(block_sizes[1] + round % diff,
+                                  right_nbytes + 1 + SHCOLL_SYNC_VALUE, left_pe);
+        }
+
+        /* The block from the left goes before the last one, or to the end */
+        block_size_round = block_sizes[0] + round % diff;
+        shmem_size_wait_until(block_size_round, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        left_nbytes = *block_size_round - 1 - SHCOLL_SYNC_VALUE;
+        shmem_size_p(block_size_round, SHCOLL_SYNC_VALUE, me);
+        shmem_size_wait_until(block_size_round, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE);
+
+        left_offset = (left_block == 0 ? total_nbytes : left_offset) - left_nbytes;
+        left_block = (left_block - 1 + PE_size) % PE_size;
+        shmem_long_atomic_inc(progress, left_pe);
+
+        /* The block from the right goes after the last one, or to the beginning */
+        if (round < nfrom_right) {
+            block_size_round = block_sizes[1] + round % diff;
+            shmem_size_wait_until(block_size_round, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+
+            right_offset = right_block == PE_size - 1 ? 0 : right_offset + right_nbytes;
+            right_block = (right_block + 1) % PE_size;
+
+            right_nbytes = *block_size_round - 1 - SHCOLL_SYNC_VALUE;
+            shmem_size_p(block_size_round, SHCOLL_SYNC_VALUE, me);
+            shmem_size_wait_until(block_size_round, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE);
+
+            shmem_long_atomic_inc(progress + 1, right_pe);
+        }
+    }
+
+    /* The neighbours must have read all the sizes before the windows are reused */
+    shmem_long_wait_until(progress, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + nfrom_left);
+    shmem_long_p(progress, SHCOLL_SYNC_VALUE, me);
+    shmem_long_wait_until(progress + 1, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + nfrom_right);
+    shmem_long_p(progress + 1, SHCOLL_SYNC_VALUE, me);
+}
+
+/*
+ * Segmented ring: every PE streams the data it has to the right PE, starting
+ * with its own block and going backwards, so that the stream fills the right
+ * PE's dest backwards from the right PE's own block.  The right PE reads the
+ * stream in segments of ring_segment_size_collect bytes as soon as they are
+ * available and makes each of them available to its own right PE at once,
+ * so a block does not have to arrive completely before it is passed on.
+ */
+inline static void
+collect_helper_ring_segmented(void *dest, const void *source, size_t nbytes,
+                              int PE_start, int logPE_stride, int PE_size,
+                              long *pSync)
+{
+    /*
+     * pSync[0] counts the bytes of the left PE's stream that are available
+     * pSync[1] is set when the right PE has read the whole stream
+     * pSync[2] receives the block size of the right PE
+     * pSync[3..] is used for exclusive prefix sum
+     */
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    int me_as = (me - PE_start) / stride;
+    int right_pe = PE_start + ((me_as + 1) % PE_size) * stride;
+    int left_pe = PE_start + ((me_as - 1 + PE_size) % PE_size) * stride;
+
+    long *available = pSync;
+    long *done = pSync + 1;
+    size_t *right_block_size = (size_t *) (pSync + 2);
+
+    size_t block_offset;
+    size_t total_nbytes;
+    size_t right_nbytes;
+    size_t stream_nbytes;
+    size_t recv_nbytes;
+    size_t sent_nbytes;
+    size_t segment_end;
+    size_t segment_nbytes;
+    size_t forward_end;
+
+    /* The size is reset before the prefix sum, so the right PE cannot set
+     * it again in the next call before it is read */
+    shmem_size_atomic_set(right_block_size, nbytes + 1 + SHCOLL_SYNC_VALUE, left_pe);
+    shmem_size_wait_until(right_block_size, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+    right_nbytes = *right_block_size - 1 - SHCOLL_SYNC_VALUE;
+    shmem_size_p(right_block_size, SHCOLL_SYNC_VALUE, me);
+
+    exclusive_prefix_sum(&block_offset, &total_nbytes, nbytes, PE_start, logPE_stride, PE_size, pSync + 3);
+
+    memcpy((char *) dest + block_offset, source, nbytes);
+
+    /* The right PE does not need its own block, the last one in my stream */
+    stream_nbytes = total_nbytes - right_nbytes;
+
+    sent_nbytes = nbytes < stream_nbytes ? nbytes : stream_nbytes;
+    if (sent_nbytes != 0) {
+        shmem_long_atomic_add(available, (long) sent_nbytes, right_pe);
+    }
+
+    for (recv_nbytes = 0; recv_nbytes < total_nbytes - nbytes; recv_nbytes += segment_nbytes) {
+        /* The segment ends where the previous one started, it must not wrap around */
+        segment_end = block_offset > recv_nbytes ? block_offset - recv_nbytes
+                                                 : block_offset + total_nbytes - recv_nbytes;
+
+        segment_nbytes = total_nbytes - nbytes - recv_nbytes;
+        segment_nbytes = segment_nbytes < ring_segment_size_collect ? segment_nbytes : ring_segment_size_collect;
+        segment_nbytes = segment_nbytes < segment_end ? segment_nbytes : segment_end;
+
+        shmem_long_wait_until(available, SHMEM_CMP_GE, (long) (recv_nbytes + segment_nbytes) + SHCOLL_SYNC_VALUE);
+        shmem_getmem((char *) dest + segment_end - segment_nbytes, (char *) dest + segment_end - segment_nbytes,
+                     segment_nbytes, left_pe);
+
+        /* My stream is my block followed by the stream of the left PE */
+        forward_end = nbytes + recv_nbytes + segment_nbytes;
+        forward_end = forward_end < stream_nbytes ? forward_end : stream_nbytes;
+        if (forward_end > sent_nbytes) {
+            shmem_long_atomic_add(available, (long) (forward_end - sent_nbytes), right_pe);
+            sent_nbytes = forward_end;
+        }
+    }
+
+    /* The left PE adds exactly the bytes I read, give them back */
+    shmem_long_atomic_add(available, -(long) (total_nbytes - nbytes), me);
+    shmem_long_atomic_inc(done, left_pe);
+
+    /* Wait until the right PE has read my stream */
+    shmem_long_wait_until(done, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+    shmem_long_p(done, SHCOLL_SYNC_VALUE, me);
+}
+
+/*
+ * Ring without the prefix sum: every PE gathers the blocks starting with its
+ * own one, so that the position of a block in the left PE's dest follows
+ * from the sizes received so far.  The left PE reads the blocks from dest,
+ * and the rotation to the PE order is done once the offset is known.
+ */
+inline static void
+collect_helper_ring_no_scan(void *dest, const void *source, size_t nbytes,
+                            int PE_start, int logPE_stride, int PE_size,
+                            long *pSync)
+{
+    /*
+     * pSync[0] counts the blocks read by the left PE
+     * pSync[1..1+RING_MAX_DIFF) is used to receive block sizes
+     */
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    int me_as = (me - PE_start) / stride;
+    int recv_from_pe = PE_start + ((me_as + 1) % PE_size) * stride;
+    int send_to_pe = PE_start + ((me_as - 1 + PE_size) % PE_size) * stride;
+
+    int round;
+    const int diff = ring_diff(PE_size - 1, RING_MAX_DIFF);
+    long *sender_progress = pSync;
+    size_t *block_sizes = (size_t *) (pSync + 1);
+    size_t *block_size_round;
+    size_t nbytes_round = nbytes;
+
+    /* Bytes gathered so far, and the bytes of the blocks of PEs
+     * me_as..PE_size-1, which precede the block of PE 0 */
+    size_t recv_nbytes = nbytes;
+    size_t block_offset = nbytes;
+
+    memcpy(dest, source, nbytes);
+
+    for (round = 0; round < PE_size - 1; round++) {
+        /* The block last gathered is ready to be read by the left PE */
+        shmem_long_wait_until(sender_progress, SHMEM_CMP_GT, round - diff + SHCOLL_SYNC_VALUE);
+        shmem_size_atomic_set(block_sizes + (round % diff), nbytes_round + 1 + SHCOLL_SYNC_VALUE, send_to_pe);
+
+        /* Wait for the size of the next block */
+        block_size_round = block_sizes + (round % diff);
+        shmem_size_wait_until(block_size_round, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        nbytes_round = *block_size_round - 1 - SHCOLL_SYNC_VALUE;
+
+        /* Reset the block size from the current round */
+        shmem_size_p(block_size_round, SHCOLL_SYNC_VALUE, me);
+        shmem_size_wait_until(block_size_round, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE);
+
+        /* The right PE has the block after all the blocks but mine */
+        shmem_getmem((char *) dest + recv_nbytes, (char *) dest + recv_nbytes - nbytes, nbytes_round, recv_from_pe);
+        recv_nbytes += nbytes_round;
+
+        if (me_as + round + 2 == PE_size) {
+            block_offset = recv_nbytes;
+        }
+
+        /* Notify the right PE that one counter is freed and the block is read */
+        shmem_long_atomic_inc(sender_progress, recv_from_pe);
+    }
+
+    /* The left PE must have read all the blocks before the rotation */
+    shmem_long_wait_until(sender_progress, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + PE_size - 1);
+    shmem_long_p(sender_progress, SHCOLL_SYNC_VALUE, me);
+
+    if (me_as != 0) {
+        rotate(dest, recv_nbytes, recv_nbytes - block_offset);
+    }
 }
 
 inline static void
@@ -285,9 +736,8 @@ collect_helper_bruck(void *dest, const void *source, size_t nbytes,
                      long *pSync)
 {
     /* pSync[0] is used for barrier
-     * pSync[1] is used for broadcast
-     * pSync[2..2+PREFIX_SUM_SYNC_SIZE) bytes are used for the prefix sum
-     * pSync[2+PREFIX_SUM_SYNC_SIZE..2+PREFIX_SUM_SYNC_SIZE+32) bytes are used for the Bruck's algorithm, block sizes */
+     * pSync[1..1+PREFIX_SUM_SYNC_SIZE) bytes are used for the prefix sum
+     * pSync[1+PREFIX_SUM_SYNC_SIZE..1+PREFIX_SUM_SYNC_SIZE+32) bytes are used for the Bruck's algorithm, block sizes */
     /* TODO change 32 with a constant */
 
     const int stride = 1 << logPE_stride;
@@ -304,22 +754,14 @@ collect_helper_bruck(void *dest, const void *source, size_t nbytes,
 
     /* pSyncs */
     long *barrier_pSync = pSync;
-    long *broadcast_pSync = barrier_pSync + 1;
-    long *prefix_sum_pSync = (broadcast_pSync + 1);
+    long *prefix_sum_pSync = barrier_pSync + 1;
     size_t *block_sizes = (size_t *) (prefix_sum_pSync + PREFIX_SUM_SYNC_SIZE);
 
     size_t block_offset;
     size_t total_nbytes;
 
-    /* Calculate prefix sum */
-    exclusive_prefix_sum(&block_offset, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
-
-    /* Broadcast the total size */
-    if (me_as == PE_size - 1) {
-        total_nbytes = block_offset + nbytes;
-    }
-
-    broadcast_size(&total_nbytes, PE_start + (PE_size - 1) * stride, PE_start, logPE_stride, PE_size, broadcast_pSync);
+    /* Calculate prefix sum and the total size */
+    exclusive_prefix_sum(&block_offset, &total_nbytes, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
 
     /* Copy the local block to the destination */
     memcpy(dest, source, nbytes);
@@ -351,17 +793,16 @@ collect_helper_bruck(void *dest, const void *source, size_t nbytes,
     rotate(dest, total_nbytes, block_offset);
 }
 
+/*
+ * Bruck's algorithm without the rotation, once the offset of the local block
+ * and the total size are known
+ */
 inline static void
-collect_helper_bruck_no_rotate(void *dest, const void *source, size_t nbytes,
-                               int PE_start, int logPE_stride, int PE_size,
-                               long *pSync)
+collect_bruck_no_rotate_exchange(void *dest, const void *source, size_t nbytes,
+                                 size_t block_offset, size_t total_nbytes,
+                                 int PE_start, int logPE_stride, int PE_size,
+                                 long *barrier_pSync, size_t *block_sizes)
 {
-    /* pSync[0] is used for barrier
-     * pSync[1] is used for broadcast
-     * pSync[2..2+PREFIX_SUM_SYNC_SIZE) bytes are used for the prefix sum
-     * pSync[2+PREFIX_SUM_SYNC_SIZE..2+PREFIX_SUM_SYNC_SIZE+32) bytes are used for the Bruck's algorithm, block sizes */
-    /* TODO change 32 with a constant */
-
     const int stride = 1 << logPE_stride;
     const int me = shmem_my_pe();
 
@@ -374,27 +815,8 @@ collect_helper_bruck_no_rotate(void *dest, const void *source, size_t nbytes,
     size_t recv_nbytes = nbytes;
     size_t round_nbytes;
 
-    /* pSyncs */
-    long *barrier_pSync = pSync;
-    long *broadcast_pSync = barrier_pSync + 1;
-    long *prefix_sum_pSync = (broadcast_pSync + 1);
-    size_t *block_sizes = (size_t *) (prefix_sum_pSync + PREFIX_SUM_SYNC_SIZE);
-
-    size_t block_offset;
-    size_t total_nbytes;
-
     size_t next_block_start;
 
-    /* Calculate prefix sum */
-    exclusive_prefix_sum(&block_offset, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
-
-    /* Broadcast the total size */
-    if (me_as == PE_size - 1) {
-        total_nbytes = block_offset + nbytes;
-    }
-
-    broadcast_size(&total_nbytes, PE_start + (PE_size - 1) * stride, PE_start, logPE_stride, PE_size, broadcast_pSync);
-
     /* Copy the local block to the destination */
     memcpy((char*) dest + block_offset, source, nbytes);
 
@@ -435,6 +857,226 @@ collect_helper_bruck_no_rotate(void *dest, const void *source, size_t nbytes,
     shcoll_barrier_binomial_tree(PE_start, logPE_stride, PE_size, barrier_pSync);
 }
 
+inline static void
+collect_helper_bruck_no_rotate(void *dest, const void *source, size_t nbytes,
+                               int PE_start, int logPE_stride, int PE_size,
+                               long *pSync)
+{
+    /* pSync[0] is used for barrier
+     * pSync[1..1+PREFIX_SUM_SYNC_SIZE) bytes are used for the prefix sum
+     * pSync[1+PREFIX_SUM_SYNC_SIZE..1+PREFIX_SUM_SYNC_SIZE+32) bytes are used for the Bruck's algorithm, block sizes */
+    /* TODO change 32 with a constant */
+
+    /* pSyncs */
+    long *barrier_pSync = pSync;
+    long *prefix_sum_pSync = barrier_pSync + 1;
+    size_t *block_sizes = (size_t *) (prefix_sum_pSync + PREFIX_SUM_SYNC_SIZE);
+
+    size_t block_offset;
+    size_t total_nbytes;
+
+    /* Calculate prefix sum and the total size */
+    exclusive_prefix_sum(&block_offset, &total_nbytes, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
+
+    collect_bruck_no_rotate_exchange(dest, source, nbytes, block_offset, total_nbytes,
+                                     PE_start, logPE_stride, PE_size, barrier_pSync, block_sizes);
+}
+
+/*
+ * Radix-k Bruck implementation
+ *
+ * In the round with the given distance, every PE reads the data gathered by
+ * the k - 1 PEs at distance, 2 * distance, ... on its right.  Their sizes
+ * arrive in separate signal words, so that the data of each peer is placed
+ * right after the data of the previous one.  With rotation == NULL the
+ * blocks are kept at their final offsets, otherwise rotation puts them in
+ * order.
+ */
+inline static void
+collect_bruck_radix(void *dest, const void *source, size_t nbytes,
+                    int PE_start, int logPE_stride, int PE_size,
+                    long *pSync, void (*rotation)(char *, size_t, size_t))
+{
+    /* pSync[0] is used for barrier
+     * pSync[1..1+PREFIX_SUM_SYNC_SIZE) bytes are used for the prefix sum
+     * pSync[1+PREFIX_SUM_SYNC_SIZE..1+PREFIX_SUM_SYNC_SIZE+32) bytes are used for the block sizes, k - 1 per round */
+
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+    const int k = bruck_radix_collect;
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    size_t distance;
+    int npeers;
+    int slot;
+    int j;
+    int peer;
+    size_t recv_nbytes = nbytes;
+    size_t round_nbytes;
+
+    /* pSyncs */
+    long *barrier_pSync = pSync;
+    long *prefix_sum_pSync = barrier_pSync + 1;
+    size_t *block_sizes = (size_t *) (prefix_sum_pSync + PREFIX_SUM_SYNC_SIZE);
+
+    size_t block_offset;
+    size_t total_nbytes;
+    size_t next_block_start;
+
+    /* Offset of the local block in dest until the rotation */
+    size_t start;
+
+    /* Calculate prefix sum and the total size */
+    exclusive_prefix_sum(&block_offset, &total_nbytes, nbytes, PE_start, logPE_stride, PE_size, prefix_sum_pSync);
+
+    start = rotation == NULL ? block_offset : 0;
+
+    /* Copy the local block to the destination */
+    memcpy((char *) dest + start, source, nbytes);
+
+    for (distance = 1, slot = 0; distance < PE_size; distance *= k, slot += npeers) {
+        npeers = (int) ((PE_size - 1) / distance) < k - 1 ? (int) ((PE_size - 1) / distance) : k - 1;
+        assert(slot + npeers <= 32);
+
+        /* Notify the partners that the data is ready */
+        for (j = 1; j <= npeers; j++) {
+            peer = (int) (PE_start + ((me_as - j * distance + PE_size) % PE_size) * stride);
+            shmem_size_atomic_set(block_sizes + slot + j - 1, recv_nbytes + 1 + SHCOLL_SYNC_VALUE, peer);
+        }
+
+        for (j = 1; j <= npeers; j++) {
+            peer = (int) (PE_start + ((me_as + j * distance) % PE_size) * stride);
+
+            /* Wait until the data is ready to be read */
+            shmem_size_wait_until(block_sizes + slot + j - 1, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+            round_nbytes = *(block_sizes + slot + j - 1) - 1 - SHCOLL_SYNC_VALUE;
+
+            /* Reset the block size */
+            shmem_size_p(block_sizes + slot + j - 1, SHCOLL_SYNC_VALUE, me);
+            shmem_size_wait_until(block_sizes + slot + j - 1, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE);
+
+            round_nbytes = recv_nbytes + round_nbytes < total_nbytes ? round_nbytes : total_nbytes - recv_nbytes;
+
+            next_block_start = start + recv_nbytes < total_nbytes ? start + recv_nbytes :
+                               start + recv_nbytes - total_nbytes;
+
+            /* The peer keeps its data at the same offset, or at 0 if rotated */
+            if (rotation != NULL) {
+                shmem_getmem_nbi((char *) dest + recv_nbytes, dest, round_nbytes, peer);
+            } else if (next_block_start + round_nbytes <= total_nbytes) {
+                shmem_getmem_nbi((char *) dest + next_block_start, (char *) dest + next_block_start,
+                                 round_nbytes, peer);
+            } else {
+                shmem_getmem_nbi((char *) dest + next_block_start, (char *) dest + next_block_start,
+                                 total_nbytes - next_block_start, peer);
+                shmem_getmem_nbi(dest, dest, round_nbytes - (total_nbytes - next_block_start), peer);
+            }
+
+            recv_nbytes += round_nbytes;
+        }
+
+        shmem_quiet();
+    }
+
+    shcoll_barrier_binomial_tree(PE_start, logPE_stride, PE_size, barrier_pSync);
+
+    if (rotation != NULL) {
+        rotation(dest, total_nbytes, block_offset);
+    }
+}
+
+inline static void
+collect_helper_bruck_radix(void *dest, const void *source, size_t nbytes,
+                           int PE_start, int logPE_stride, int PE_size,
+                           long *pSync)
+{
+    collect_bruck_radix(dest, source, nbytes, PE_start, logPE_stride, PE_size, pSync, rotate);
+}
+
+inline static void
+collect_helper_bruck_radix_no_rotate(void *dest, const void *source, size_t nbytes,
+                                     int PE_start, int logPE_stride, int PE_size,
+                                     long *pSync)
+{
+    collect_bruck_radix(dest, source, nbytes, PE_start, logPE_stride, PE_size, pSync, NULL);
+}
+
+inline static void
+collect_helper_bruck_radix_inplace(void *dest, const void *source, size_t nbytes,
+                                   int PE_start, int logPE_stride, int PE_size,
+                                   long *pSync)
+{
+    collect_bruck_radix(dest, source, nbytes, PE_start, logPE_stride, PE_size, pSync, rotate_inplace);
+}
+
+/*
+ * Planned collect: the offset of the local block and the total size are
+ * cached in the plan, and the prefix sum is repeated only when a PE calls
+ * with a different size than in the previous call.  Finding that out takes
+ * a single word per round, instead of the two of the prefix sum.
+ */
+
+struct shcoll_collect_plan {
+    int PE_start;
+    int logPE_stride;
+    int PE_size;
+    size_t nbytes;
+    size_t block_offset;
+    size_t total_nbytes;
+};
+
+shcoll_collect_plan_t *
+shcoll_collect_plan_create(size_t nbytes, int PE_start, int logPE_stride, int PE_size, long *pSync)
+{
+    shcoll_collect_plan_t *plan = malloc(sizeof(shcoll_collect_plan_t));
+
+    if (plan == NULL) {
+        /* TODO: raise error */
+        fprintf(stderr, "PE %d: Cannot allocate memory!\n", shmem_my_pe());
+        exit(-1);
+    }
+
+    plan->PE_start = PE_start;
+    plan->logPE_stride = logPE_stride;
+    plan->PE_size = PE_size;
+    plan->nbytes = nbytes;
+
+    exclusive_prefix_sum(&plan->block_offset, &plan->total_nbytes, nbytes, PE_start, logPE_stride, PE_size,
+                         pSync + 1);
+
+    return plan;
+}
+
+void
+shcoll_collect_plan_destroy(shcoll_collect_plan_t *plan)
+{
+    free(plan);
+}
+
+inline static void
+collect_helper_planned(shcoll_collect_plan_t *plan, void *dest, const void *source, size_t nbytes, long *pSync)
+{
+    /* pSync[0] is used for barrier
+     * pSync[1..1+PREFIX_SUM_SYNC_SIZE) bytes are used for the prefix sum
+     * pSync[1+PREFIX_SUM_SYNC_SIZE..1+PREFIX_SUM_SYNC_SIZE+32) bytes are used for the Bruck's algorithm, block sizes
+     * pSync[1+PREFIX_SUM_SYNC_SIZE+32..1+PREFIX_SUM_SYNC_SIZE+32+PE_SIZE_LOG) bytes are used to check the sizes */
+
+    long *barrier_pSync = pSync;
+    long *prefix_sum_pSync = barrier_pSync + 1;
+    size_t *block_sizes = (size_t *) (prefix_sum_pSync + PREFIX_SUM_SYNC_SIZE);
+    long *check_pSync = prefix_sum_pSync + PREFIX_SUM_SYNC_SIZE + 32;
+
+    if (logical_or_all(nbytes != plan->nbytes, plan->PE_start, plan->logPE_stride, plan->PE_size, check_pSync)) {
+        plan->nbytes = nbytes;
+        exclusive_prefix_sum(&plan->block_offset, &plan->total_nbytes, nbytes,
+                             plan->PE_start, plan->logPE_stride, plan->PE_size, prefix_sum_pSync);
+    }
+
+    collect_bruck_no_rotate_exchange(dest, source, nbytes, plan->block_offset, plan->total_nbytes,
+                                     plan->PE_start, plan->logPE_stride, plan->PE_size, barrier_pSync, block_sizes);
+}
+
 #define SHCOLL_COLLECT_DEFINITION(_name, _size)                         \
     void                                                                \
     shcoll_collect##_size##_##_name(void *dest, const void *source,     \
@@ -450,6 +1092,16 @@ collect_helper_bruck_no_rotate(void *dest, const void *source, size_t nbytes,
     }                                                                   \
 
 
+#define SHCOLL_COLLECT_PLANNED_DEFINITION(_size)                        \
+    void                                                                \
+    shcoll_collect##_size##_planned(shcoll_collect_plan_t *plan,        \
+                                    void *dest, const void *source,     \
+                                    size_t nelems, long *pSync)         \
+    {                                                                   \
+        collect_helper_planned(plan, dest, source,                      \
+                               (_size) / CHAR_BIT * nelems, pSync);     \
+    }
+
 /* @formatter:off */
 
 SHCOLL_COLLECT_DEFINITION(linear, 32)
@@ -467,13 +1119,40 @@ SHCOLL_COLLECT_DEFINITION(rec_dbl, 64)
 SHCOLL_COLLECT_DEFINITION(rec_dbl_signal, 32)
 SHCOLL_COLLECT_DEFINITION(rec_dbl_signal, 64)
 
+SHCOLL_COLLECT_DEFINITION(rec_dbl_fold, 32)
+SHCOLL_COLLECT_DEFINITION(rec_dbl_fold, 64)
+
+SHCOLL_COLLECT_DEFINITION(rec_dbl_no_scan, 32)
+SHCOLL_COLLECT_DEFINITION(rec_dbl_no_scan, 64)
+
 SHCOLL_COLLECT_DEFINITION(ring, 32)
 SHCOLL_COLLECT_DEFINITION(ring, 64)
 
+SHCOLL_COLLECT_DEFINITION(bidir_ring, 32)
+SHCOLL_COLLECT_DEFINITION(bidir_ring, 64)
+
+SHCOLL_COLLECT_DEFINITION(ring_segmented, 32)
+SHCOLL_COLLECT_DEFINITION(ring_segmented, 64)
+
+SHCOLL_COLLECT_DEFINITION(ring_no_scan, 32)
+SHCOLL_COLLECT_DEFINITION(ring_no_scan, 64)
+
 SHCOLL_COLLECT_DEFINITION(bruck, 32)
 SHCOLL_COLLECT_DEFINITION(bruck, 64)
 
 SHCOLL_COLLECT_DEFINITION(bruck_no_rotate, 32)
 SHCOLL_COLLECT_DEFINITION(bruck_no_rotate, 64)
 
+SHCOLL_COLLECT_DEFINITION(bruck_radix, 32)
+SHCOLL_COLLECT_DEFINITION(bruck_radix, 64)
+
+SHCOLL_COLLECT_DEFINITION(bruck_radix_no_rotate, 32)
+SHCOLL_COLLECT_DEFINITION(bruck_radix_no_rotate, 64)
+
+SHCOLL_COLLECT_DEFINITION(bruck_radix_inplace, 32)
+SHCOLL_COLLECT_DEFINITION(bruck_radix_inplace, 64)
+
+SHCOLL_COLLECT_PLANNED_DEFINITION(32)
+SHCOLL_COLLECT_PLANNED_DEFINITION(64)
+
 /* @formatter:on */
@@ -11,6 +11,20 @@
 #include <string.h>
 #include <assert.h>
 
+static int bruck_radix_fcollect = 2;
+static size_t ring_segment_size_fcollect = 65536;
+
+void
+shcoll_set_fcollect_bruck_radix(int radix)
+{
+    bruck_radix_fcollect = radix;
+}
+
+void
+shcoll_set_fcollect_ring_segment_size(size_t segment_size)
+{
+    ring_segment_size_fcollect = segment_size;
+}
 
 /**
  @param pSync pSync should have at least 2 elements
@@ -125,6 +139,203 @@ fcollect_helper_rec_dbl(void *dest, const void *source, size_t nbytes,
     }
 }
 
+/*
+ * Bidirectional ring: the blocks travel both to the right and to the left,
+ * so each of them makes at most ⌈(PE_size - 1) / 2⌉ hops and PE_size can be
+ * odd.  The counters are given back as in fcollect_helper_neighbor_exchange.
+ *
+ * @param pSync pSync should have at least 2 elements
+ */
+inline static void
+fcollect_helper_bidir_ring(void *dest, const void *source, size_t nbytes,
+                           int PE_start, int logPE_stride, int PE_size,
+                           long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    int right_pe = PE_start + ((me_as + 1) % PE_size) * stride;
+    int left_pe = PE_start + ((me_as - 1 + PE_size) % PE_size) * stride;
+
+    /* Number of blocks that come from the left and from the right neighbor */
+    int nfrom_left = PE_size / 2;
+    int nfrom_right = (PE_size - 1) / 2;
+    int left_block = me_as;
+    int right_block = me_as;
+    long received[2] = {SHCOLL_SYNC_VALUE, SHCOLL_SYNC_VALUE};
+    int i;
+
+    memcpy((char *) dest + me_as * nbytes, source, nbytes);
+
+    for (i = 0; i < nfrom_left; i++) {
+        /* Pass on the blocks received in the previous round */
+        shmem_putmem_nbi((char *) dest + left_block * nbytes, (char *) dest + left_block * nbytes, nbytes, right_pe);
+        if (i < nfrom_right) {
+            shmem_putmem_nbi((char *) dest + right_block * nbytes, (char *) dest + right_block * nbytes, nbytes, left_pe);
+        }
+        shmem_fence();
+
+        shmem_long_atomic_inc(pSync, right_pe);
+        if (i < nfrom_right) {
+            shmem_long_atomic_inc(pSync + 1, left_pe);
+        }
+
+        left_block = (left_block - 1 + PE_size) % PE_size;
+        shmem_long_wait_until(pSync, SHMEM_CMP_GE, ++received[0]);
+
+        if (i < nfrom_right) {
+            right_block = (right_block + 1) % PE_size;
+            shmem_long_wait_until(pSync + 1, SHMEM_CMP_GE, ++received[1]);
+        }
+    }
+
+    shmem_long_atomic_add(pSync, SHCOLL_SYNC_VALUE - received[0], me);
+    shmem_long_atomic_add(pSync + 1, SHCOLL_SYNC_VALUE - received[1], me);
+}
+
+/*
+ * Segmented ring: the blocks are sent in segments of ring_segment_size_fcollect
+ * bytes and a segment is passed on as soon as it arrives, while the rest of
+ * the block is still on the way.  pSync[0] counts the segments received and
+ * is given back as in fcollect_helper_neighbor_exchange.
+ *
+ * @param pSync pSync should have at least 1 element
+ */
+inline static void
+fcollect_helper_ring_segmented(void *dest, const void *source, size_t nbytes,
+                               int PE_start, int logPE_stride, int PE_size,
+                               long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    int peer = PE_start + ((me_as + 1) % PE_size) * stride;
+    int data_block;
+
+    const size_t segment_size = ring_segment_size_fcollect < nbytes ? ring_segment_size_fcollect : nbytes;
+    const size_t nsegments = segment_size == 0 ? 0 : (nbytes + segment_size - 1) / segment_size;
+    const size_t total_segments = (PE_size - 1) * nsegments;
+    size_t segment_offset;
+    size_t segment_nbytes;
+    size_t i;
+    long received = SHCOLL_SYNC_VALUE;
+
+    memcpy((char *) dest + me_as * nbytes, source, nbytes);
+
+    for (i = 0; i < total_segments; i++) {
+        data_block = (int) ((me_as - i / nsegments + PE_size) % PE_size);
+        segment_offset = (i % nsegments) * segment_size;
+        segment_nbytes = nbytes - segment_offset < segment_size ? nbytes - segment_offset : segment_size;
+
+        /* Wait for the same segment of the block received in the previous step */
+        if (i >= nsegments) {
+            shmem_long_wait_until(pSync, SHMEM_CMP_GE, received + (long) (i - nsegments) + 1);
+        }
+
+        shmem_putmem_nbi((char *) dest + data_block * nbytes + segment_offset,
+                         (char *) dest + data_block * nbytes + segment_offset, segment_nbytes, peer);
+        shmem_fence();
+        shmem_long_atomic_inc(pSync, peer);
+    }
+
+    received += (long) total_segments;
+    shmem_long_wait_until(pSync, SHMEM_CMP_GE, received);
+    shmem_long_atomic_add(pSync, SHCOLL_SYNC_VALUE - received, me);
+}
+
+/*
+ * Recursive doubling for any PE_size
+ *
+ * The largest power of 2 not greater than PE_size forms the "power 2 set", as
+ * in the Rabenseifner reduction.  Each remaining PE hands its block over to
+ * the member on its left before the exchange and gets the result afterwards,
+ * so member j owns the blocks from its own up to the one of member j + 1.
+ *
+ * @param pSync pSync should have at least PE_SIZE_LOG + 1 elements
+ */
+inline static void
+fcollect_helper_rec_dbl_fold(void *dest, const void *source, size_t nbytes,
+                             int PE_start, int logPE_stride, int PE_size,
+                             long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    int mask;
+    int peer;
+    int i;
+    int data_block;
+    int block_begin;
+    int block_end;
+    int follower_as;
+
+    /* Power 2 set */
+    int me_p2s;
+    int p2s_size;
+
+    long *fold_pSync = pSync + PE_SIZE_LOG;
+
+    /* Find the greatest power of 2 lower than PE_size */
+    for (p2s_size = 1; p2s_size * 2 <= PE_size; p2s_size *= 2);
+
+    /* Check if the current PE belongs to the power 2 set */
+    me_p2s = me_as * p2s_size / PE_size;
+    if ((me_p2s * PE_size + p2s_size - 1) / p2s_size != me_as) {
+        peer = PE_start + (me_as - 1) * stride;
+
+        shmem_putmem_nbi((char*) dest + me_as * nbytes, source, nbytes, peer);
+        shmem_fence();
+        shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE + 1, peer);
+
+        shmem_long_wait_until(fold_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);
+        return;
+    }
+
+    memcpy((char*) dest + me_as * nbytes, source, nbytes);
+
+    /* There is at most one PE between two members of the power 2 set */
+    follower_as = ((me_p2s + 1) * PE_size + p2s_size - 1) / p2s_size > me_as + 1 ? me_as + 1 : -1;
+
+    if (follower_as != -1) {
+        shmem_long_wait_until(fold_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);
+    }
+
+    data_block = me_p2s;
+
+    for (mask = 0x1, i = 0; mask < p2s_size; mask <<= 1, i++) {
+        peer = PE_start + (((me_p2s ^ mask) * PE_size + p2s_size - 1) / p2s_size) * stride;
+
+        block_begin = (data_block * PE_size + p2s_size - 1) / p2s_size;
+        block_end = ((data_block + mask) * PE_size + p2s_size - 1) / p2s_size;
+
+        shmem_putmem_nbi((char*) dest + block_begin * nbytes, (char*) dest + block_begin * nbytes,
+                         (block_end - block_begin) * nbytes, peer);
+        shmem_fence();
+        shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, peer);
+
+        data_block &= ~mask;
+
+        shmem_long_wait_until(pSync + i, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);
+    }
+
+    if (follower_as != -1) {
+        peer = PE_start + follower_as * stride;
+
+        shmem_putmem_nbi(dest, dest, PE_size * nbytes, peer);
+        shmem_fence();
+        shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE + 1, peer);
+    }
+}
+
 /**
  * @param pSync pSync should have at least 1 element
  */
@@ -314,7 +525,112 @@ fcollect_helper_bruck_inplace(void *dest, const void *source, size_t nbytes,
     rotate_inplace(dest, total_nbytes, me_as * nbytes);
 }
 
+/*
+ * Radix-k Bruck implementation
+ *
+ * In the round with the given distance, every PE sends the distance blocks
+ * it has to the k - 1 PEs at distance, 2 * distance, ... on its left, so
+ * there are ceil(log_k(PE_size)) rounds.  With rotation == NULL the blocks
+ * are kept at their final offsets, otherwise rotation puts them in order.
+ */
+inline static void
+fcollect_bruck_radix(void *dest, const void *source, size_t nbytes,
+                     int PE_start, int logPE_stride, int PE_size,
+                     long *pSync, void (*rotation)(char *, size_t, size_t))
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+    const int k = bruck_radix_fcollect;
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    size_t distance;
+    int round;
+    int peer;
+    int nsend;
+    int j;
+    size_t total_nbytes = PE_size * nbytes;
+    size_t to_send;
+
+    size_t my_offset_nbytes = rotation == NULL ? nbytes * me_as : 0;
+    char *my_offset = (char *) dest + my_offset_nbytes;
+
+    memcpy(my_offset, source, nbytes);
+
+    for (distance = 1, round = 0; distance < PE_size; distance *= k, round++) {
+        for (j = 1; j < k && j * distance < PE_size; j++) {
+            peer = (int) (PE_start + ((me_as - j * distance + PE_size) % PE_size) * stride);
+            to_send = (distance < PE_size - j * distance ? distance : PE_size - j * distance) * nbytes;
+
+            if (rotation != NULL) {
+                shmem_putmem_nbi((char *) dest + j * distance * nbytes, dest, to_send, peer);
+            } else if (my_offset_nbytes + to_send <= total_nbytes) {
+                shmem_putmem_nbi(my_offset, my_offset, to_send, peer);
+            } else {
+                shmem_putmem_nbi(my_offset, my_offset, total_nbytes - my_offset_nbytes, peer);
+                shmem_putmem_nbi(dest, dest, to_send - (total_nbytes - my_offset_nbytes), peer);
+            }
+        }
+
+        nsend = j - 1;
+        shmem_fence();
+
+        for (j = 1; j <= nsend; j++) {
+            peer = (int) (PE_start + ((me_as - j * distance + PE_size) % PE_size) * stride);
+            shmem_long_atomic_inc(pSync + round, peer);
+        }
+
+        /* As many PEs send to the current PE as it sends to, a sender may
+         * already be in the next call, so the messages read are given back
+         * as in fcollect_helper_neighbor_exchange */
+        shmem_long_wait_until(pSync + round, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + nsend);
+        shmem_long_atomic_add(pSync + round, -nsend, me);
+    }
+
+    if (rotation != NULL) {
+        rotation(dest, total_nbytes, me_as * nbytes);
+    }
+}
+
+/**
+ * @param pSync pSync should have at least ⌈log_k(max_rank)⌉ elements
+ */
+inline static void
+fcollect_helper_bruck_radix(void *dest, const void *source, size_t nbytes,
+                            int PE_start, int logPE_stride, int PE_size,
+                            long *pSync)
+{
+    fcollect_bruck_radix(dest, source, nbytes, PE_start, logPE_stride, PE_size, pSync, rotate);
+}
+
+/**
+ * @param pSync pSync should have at least ⌈log_k(max_rank)⌉ elements
+ */
+inline static void
+fcollect_helper_bruck_radix_no_rotate(void *dest, const void *source, size_t nbytes,
+                                      int PE_start, int logPE_stride, int PE_size,
+                                      long *pSync)
+{
+    fcollect_bruck_radix(dest, source, nbytes, PE_start, logPE_stride, PE_size, pSync, NULL);
+}
+
 /**
+ * @param pSync pSync should have at least ⌈log_k(max_rank)⌉ elements
+ */
+inline static void
+fcollect_helper_bruck_radix_inplace(void *dest, const void *source, size_t nbytes,
+                                    int PE_start, int logPE_stride, int PE_size,
+                                    long *pSync)
+{
+    fcollect_bruck_radix(dest, source, nbytes, PE_start, logPE_stride, PE_size, pSync, rotate_inplace);
+}
+
+/**
+ * pSync[0] and pSync[1] count the messages from the two neighbors.  A neighbor
+ * may already be in the next call when the last message of this one is read,
+ * so the messages read are subtracted instead of resetting the counters, which
+ * would lose the ones of the next call.
+ *
  * @param pSync pSync should have at least 2 elements
  */
 inline static void
@@ -334,6 +650,7 @@ fcollect_helper_neighbor_exchange(void *dest, const void *source,
 
     int i, parity;
     void *data;
+    long received[2] = {SHCOLL_SYNC_VALUE, SHCOLL_SYNC_VALUE};
 
     /* Get my index in the active set */
     int me_as = (me - PE_start) / stride;
@@ -365,7 +682,7 @@ fcollect_helper_neighbor_exchange(void *dest, const void *source,
     shmem_fence();
     shmem_long_atomic_inc(pSync, neighbor_pe[0]);
 
-    shmem_long_wait_until(pSync, SHMEM_CMP_GE, 1);
+    shmem_long_wait_until(pSync, SHMEM_CMP_GE, ++received[0]);
 
     /* Remaining npes/2 - 1 rounds */
     for (i = 1; i < PE_size / 2; i++) {
@@ -382,11 +699,11 @@ fcollect_helper_neighbor_exchange(void *dest, const void *source,
         send_offset_diff = PE_size - send_offset_diff;
 
         /* Wait for the data from the neighbor */
-        shmem_long_wait_until(pSync + parity, SHMEM_CMP_GT, i / 2);
+        shmem_long_wait_until(pSync + parity, SHMEM_CMP_GE, ++received[parity]);
     }
 
-    pSync[0] = SHCOLL_SYNC_VALUE;
-    pSync[1] = SHCOLL_SYNC_VALUE;
+    shmem_long_atomic_add(pSync, SHCOLL_SYNC_VALUE - received[0], me);
+    shmem_long_atomic_add(pSync + 1, SHCOLL_SYNC_VALUE - received[1], me);
 }
 
 #define SHCOLL_FCOLLECT_DEFINITION(_name, _size)                        \
@@ -417,9 +734,18 @@ SHCOLL_FCOLLECT_DEFINITION(all_linear1, 64)
 SHCOLL_FCOLLECT_DEFINITION(rec_dbl, 32)
 SHCOLL_FCOLLECT_DEFINITION(rec_dbl, 64)
 
+SHCOLL_FCOLLECT_DEFINITION(rec_dbl_fold, 32)
+SHCOLL_FCOLLECT_DEFINITION(rec_dbl_fold, 64)
+
 SHCOLL_FCOLLECT_DEFINITION(ring, 32)
 SHCOLL_FCOLLECT_DEFINITION(ring, 64)
 
+SHCOLL_FCOLLECT_DEFINITION(bidir_ring, 32)
+SHCOLL_FCOLLECT_DEFINITION(bidir_ring, 64)
+
+SHCOLL_FCOLLECT_DEFINITION(ring_segmented, 32)
+SHCOLL_FCOLLECT_DEFINITION(ring_segmented, 64)
+
 SHCOLL_FCOLLECT_DEFINITION(bruck, 32)
 SHCOLL_FCOLLECT_DEFINITION(bruck, 64)
 
@@ -432,6 +758,15 @@ SHCOLL_FCOLLECT_DEFINITION(bruck_signal, 64)
 SHCOLL_FCOLLECT_DEFINITION(bruck_inplace, 32)
 SHCOLL_FCOLLECT_DEFINITION(bruck_inplace, 64)
 
+SHCOLL_FCOLLECT_DEFINITION(bruck_radix, 32)
+SHCOLL_FCOLLECT_DEFINITION(bruck_radix, 64)
+
+SHCOLL_FCOLLECT_DEFINITION(bruck_radix_no_rotate, 32)
+SHCOLL_FCOLLECT_DEFINITION(bruck_radix_no_rotate, 64)
+
+SHCOLL_FCOLLECT_DEFINITION(bruck_radix_inplace, 32)
+SHCOLL_FCOLLECT_DEFINITION(bruck_radix_inplace, 64)
+
 SHCOLL_FCOLLECT_DEFINITION(neighbor_exchange, 32)
 SHCOLL_FCOLLECT_DEFINITION(neighbor_exchange, 64)
 
@@ -0,0 +1,222 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#include "shcoll.h"
+#include "shcoll/compat.h"
+#include "util/trees.h"
+#include "util/scan.h"
+#include "util/rotate.h"
+
+#include <string.h>
+#include <limits.h>
+
+static int knomial_tree_radix_gather = 2;
+
+void
+shcoll_set_gather_knomial_tree_radix(int tree_radix)
+{
+    knomial_tree_radix_gather = tree_radix;
+}
+
+/*
+ * The helpers get the position of the block of the current PE in the result
+ * and the size of the result, the gather variants compute them from nbytes
+ * and the gatherv variants with exclusive_prefix_sum.
+ *
+ * pSync[0..3) are used by the helpers
+ * pSync[4..4+PREFIX_SUM_SYNC_SIZE) is used for exclusive prefix sum
+ *
+ * A PE is done with the gather as soon as its blocks are sent, so it may start
+ * the prefix sum of the next call while another PE is still in the one of the
+ * current call: the gatherv variants use the acked prefix sum.
+ */
+
+inline static void
+gather_helper_linear(void *dest, const void *source, size_t nbytes,
+                     size_t block_offset, size_t total_nbytes,
+                     int PE_root, int PE_start, int logPE_stride, int PE_size,
+                     long *pSync)
+{
+    /* pSync[0] counts the blocks received by the root
+     * pSync[1] is set by the root when its dest can be written */
+
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+    const int me_as = (me - PE_start) / stride;
+    const int root = PE_start + PE_root * stride;
+    int i;
+
+    if (me_as == PE_root) {
+        for (i = 0; i < PE_size; i++) {
+            if (i != PE_root) {
+                shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE + 1, PE_start + i * stride);
+            }
+        }
+
+        memcpy((char *) dest + block_offset, source, nbytes);
+
+        shmem_long_wait_until(pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + PE_size - 1);
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
+    } else {
+        shmem_long_wait_until(pSync + 1, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE, me);
+
+        shmem_putmem_nbi((char *) dest + block_offset, source, nbytes, root);
+        shmem_fence();
+        shmem_long_atomic_inc(pSync, root);
+    }
+}
+
+/*
+ * Tree gather: every PE gathers the blocks of its subtree in its own dest,
+ * starting with its own block, so dest must be large enough for the whole
+ * result on all the PEs.  The subtree of a child follows the blocks of the
+ * parent and of the preceding children, the parent sends its block offset to
+ * the children so they can tell where.  The root rotates the result to the
+ * PE order at the end.
+ */
+inline static void
+gather_helper_tree(void *dest, const void *source, size_t nbytes,
+                   size_t block_offset, size_t total_nbytes,
+                   int PE_start, int logPE_stride,
+                   int parent, const int *children, int children_num,
+                   long *pSync)
+{
+    /* pSync[0] receives the block offset of the parent
+     * pSync[1] sums the sizes of the subtrees of the children
+     * pSync[2] counts the children that are done */
+
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    size_t *parent_offset = (size_t *) pSync;
+    size_t *children_nbytes = (size_t *) (pSync + 1);
+    long *children_done = pSync + 2;
+
+    size_t subtree_nbytes = nbytes;
+    size_t offset;
+    int parent_pe;
+    int i;
+
+    for (i = 0; i < children_num; i++) {
+        shmem_size_atomic_set(parent_offset, block_offset + 1 + SHCOLL_SYNC_VALUE, PE_start + children[i] * stride);
+    }
+
+    memcpy(dest, source, nbytes);
+
+    if (children_num != 0) {
+        shmem_long_wait_until(children_done, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + children_num);
+        subtree_nbytes += *children_nbytes - SHCOLL_SYNC_VALUE;
+
+        shmem_size_p(children_nbytes, SHCOLL_SYNC_VALUE, me);
+        shmem_long_p(children_done, SHCOLL_SYNC_VALUE, me);
+    }
+
+    if (parent == -1) {
+        rotate(dest, total_nbytes, block_offset);
+        return;
+    }
+
+    parent_pe = PE_start + parent * stride;
+
+    shmem_size_wait_until(parent_offset, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+    offset = *parent_offset - 1 - SHCOLL_SYNC_VALUE;
+    shmem_size_p(parent_offset, SHCOLL_SYNC_VALUE, me);
+
+    /* Position of my subtree in the dest of the parent */
+    offset = block_offset >= offset ? block_offset - offset : block_offset + total_nbytes - offset;
+
+    shmem_putmem_nbi((char *) dest + offset, dest, subtree_nbytes, parent_pe);
+    shmem_fence();
+    shmem_size_atomic_add(children_nbytes, subtree_nbytes, parent_pe);
+    shmem_fence();
+    shmem_long_atomic_inc(children_done, parent_pe);
+}
+
+inline static void
+gather_helper_binomial_tree(void *dest, const void *source, size_t nbytes,
+                            size_t block_offset, size_t total_nbytes,
+                            int PE_root, int PE_start, int logPE_stride, int PE_size,
+                            long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me_as = (shmem_my_pe() - PE_start) / stride;
+    node_info_binomial_t node;
+
+    get_node_info_binomial_root(PE_size, PE_root, me_as, &node);
+
+    gather_helper_tree(dest, source, nbytes, block_offset, total_nbytes, PE_start, logPE_stride,
+                       node.parent, node.children, node.children_num, pSync);
+}
+
+inline static void
+gather_helper_knomial_tree(void *dest, const void *source, size_t nbytes,
+                           size_t block_offset, size_t total_nbytes,
+                           int PE_root, int PE_start, int logPE_stride, int PE_size,
+                           long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me_as = (shmem_my_pe() - PE_start) / stride;
+    node_info_knomial_t node;
+
+    get_node_info_knomial_root(PE_size, PE_root, knomial_tree_radix_gather, me_as, &node);
+
+    gather_helper_tree(dest, source, nbytes, block_offset, total_nbytes, PE_start, logPE_stride,
+                       node.parent, node.children, node.children_num, pSync);
+}
+
+#define SHCOLL_GATHER_DEFINITION(_name, _size)                          \
+    void                                                                \
+    shcoll_gather##_size##_##_name(void *dest, const void *source,      \
+                                   size_t nelems, int PE_root,          \
+                                   int PE_start, int logPE_stride,      \
+                                   int PE_size, long *pSync)            \
+    {                                                                   \
+        const size_t nbytes = (_size) / CHAR_BIT * nelems;              \
+        const int me_as = (shmem_my_pe() - PE_start) / (1 << logPE_stride); \
+                                                                        \
+        gather_helper_##_name(dest, source, nbytes,                     \
+                              me_as * nbytes, PE_size * nbytes,         \
+                              PE_root, PE_start, logPE_stride, PE_size, \
+                              pSync);                                   \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_gatherv##_size##_##_name(void *dest, const void *source,     \
+                                    size_t nelems, int PE_root,         \
+                                    int PE_start, int logPE_stride,     \
+                                    int PE_size, long *pSync)           \
+    {                                                                   \
+        const size_t nbytes = (_size) / CHAR_BIT * nelems;              \
+        size_t block_offset;                                            \
+        size_t total_nbytes;                                            \
+                                                                        \
+        exclusive_prefix_sum_acked(&block_offset, &total_nbytes, nbytes, \
+                                   PE_start, logPE_stride, PE_size,     \
+                                   pSync + 4);                          \
+                                                                        \
+        gather_helper_##_name(dest, source, nbytes,                     \
+                              block_offset, total_nbytes,               \
+                              PE_root, PE_start, logPE_stride, PE_size, \
+                              pSync);                                   \
+    }
+
+/* @formatter:off */
+
+SHCOLL_GATHER_DEFINITION(linear, 8)
+SHCOLL_GATHER_DEFINITION(linear, 16)
+SHCOLL_GATHER_DEFINITION(linear, 32)
+SHCOLL_GATHER_DEFINITION(linear, 64)
+
+SHCOLL_GATHER_DEFINITION(binomial_tree, 8)
+SHCOLL_GATHER_DEFINITION(binomial_tree, 16)
+SHCOLL_GATHER_DEFINITION(binomial_tree, 32)
+SHCOLL_GATHER_DEFINITION(binomial_tree, 64)
+
+SHCOLL_GATHER_DEFINITION(knomial_tree, 8)
+SHCOLL_GATHER_DEFINITION(knomial_tree, 16)
+SHCOLL_GATHER_DEFINITION(knomial_tree, 32)
+SHCOLL_GATHER_DEFINITION(knomial_tree, 64)
+
+/* @formatter:on */
@@ -4,38 +4,296 @@
 
 #include "shcoll.h"
 #include "util/bithacks.h"
+#include "util/trees.h"
+#include "util/reduce-ops.h"
+#include "util/half.h"
+#include "util/memfence.h"
+#include "util/scan.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>
 
+static int knomial_tree_radix_reduce = 2;
+static size_t reduce_segment_size = 8192;
+static int rec_mult_radix_reduce = 4;
+static size_t reduce_rabenseifner_threshold = 8192;
+static double reduce_sparse_density = 0.1;
+static int reduce_node_size = 0;
+static int reduce_nthreads = 1;
+
+void
+shcoll_set_reduce_knomial_tree_radix(int tree_radix)
+{
+    knomial_tree_radix_reduce = tree_radix;
+}
+
+void
+shcoll_set_reduce_segment_size(size_t segment_size)
+{
+    reduce_segment_size = segment_size;
+}
+
+void
+shcoll_set_reduce_rec_mult_radix(int radix)
+{
+    rec_mult_radix_reduce = radix;
+}
+
+void
+shcoll_set_reduce_rabenseifner_threshold(size_t threshold)
+{
+    reduce_rabenseifner_threshold = threshold;
+}
+
+void
+shcoll_set_reduce_sparse_density(double density)
+{
+    reduce_sparse_density = density;
+}
+
+void
+shcoll_set_reduce_node_size(int node_size)
+{
+    reduce_node_size = node_size;
+}
+
+void
+shcoll_set_reduce_threads(int nthreads)
+{
+    reduce_nthreads = nthreads;
+}
+
 /*
- * Local reduce helper
+ * Returns the number of the PEs from first_pe on whose buffers can be accessed
+ * with shmem_ptr, up to count
  */
+inline static int
+reduce_count_reachable(const void *dest, const void *source, const void *pWrk,
+                       int first_pe, int stride, int count)
+{
+    int pe;
+    int i;
 
-#define REDUCE_HELPER_LOCAL(_name, _type, _op)                  \
-    inline static void                                          \
-    local_##_name##_reduce(_type *dest, const _type *src1,      \
-                           const _type *src2, size_t nreduce)   \
-    {                                                           \
-        size_t i;                                               \
-                                                                \
-        for (i = 0; i < nreduce; i++) {                         \
-            dest[i] = _op(src1[i], src2[i]);                    \
-        }                                                       \
+    for (i = 0; i < count; i++) {
+        pe = first_pe + i * stride;
+        if (shmem_ptr(dest, pe) == NULL || shmem_ptr(source, pe) == NULL ||
+            shmem_ptr(pWrk, pe) == NULL) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/*
+ * Returns the number of PEs per node, the nodes are made of consecutive PEs
+ * of the active set.  Unless it is set explicitly, it is the largest number
+ * of PEs whose buffers a PE can access with shmem_ptr, which assumes that all
+ * the nodes but the last are full.  The PEs agree on it with max_all, and
+ * check that they reach all the PEs of their node with logical_or_all: if
+ * any of them does not, all of them get 1 and the reduction is flat.
+ *
+ * pSync[0..PE_SIZE_LOG) and pSync[PE_SIZE_LOG..2 * PE_SIZE_LOG) are used
+ */
+inline static int
+reduce_get_node_size(const void *dest, const void *source, const void *pWrk,
+                     int PE_start, int logPE_stride, int PE_size, long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me_as = (shmem_my_pe() - PE_start) / stride;
+    int node_size;
+    int local_size;
+    int leader_as;
+
+    if (reduce_node_size > 0) {
+        node_size = reduce_node_size < PE_size ? reduce_node_size : PE_size;
+    } else {
+        node_size = reduce_count_reachable(dest, source, pWrk, PE_start, stride, PE_size);
+        node_size = (int) max_all((size_t) node_size, PE_start, logPE_stride, PE_size, pSync);
+    }
+
+    if (node_size <= 1) {
+        return 1;
+    }
+
+    leader_as = me_as - me_as % node_size;
+    local_size = PE_size - leader_as < node_size ? PE_size - leader_as : node_size;
+
+    if (logical_or_all(reduce_count_reachable(dest, source, pWrk, PE_start + leader_as * stride,
+                                              stride, local_size) != local_size,
+                       PE_start, logPE_stride, PE_size, pSync + PE_SIZE_LOG)) {
+        return 1;
+    }
+
+    return node_size;
+}
+
+/*
+ * Returns the offset of block idx when nelems elements are split into nblocks
+ * nearly equal blocks, i.e. idx * nelems / nblocks without overflowing
+ */
+inline static size_t
+reduce_block_offset(size_t idx, size_t nelems, size_t nblocks)
+{
+    return idx * (nelems / nblocks) + idx * (nelems % nblocks) / nblocks;
+}
+
+/*
+ * Threaded local work for large vectors (needs OpenMP, off by default)
+ *
+ * The vector is split into one contiguous chunk per thread, scratch buffers
+ * are first touched with the same split so that their pages are allocated
+ * on the NUMA node of the thread that combines them.
+ */
+
+/* Below this many bytes per thread, the threads do not pay off */
+#define REDUCE_THREAD_MIN_BYTES (1 << 16)
+
+inline static int
+reduce_threads_for(size_t nbytes)
+{
+    size_t nthreads = (size_t) reduce_nthreads;
+
+    if (nbytes / REDUCE_THREAD_MIN_BYTES < nthreads) {
+        nthreads = nbytes / REDUCE_THREAD_MIN_BYTES;
+    }
+
+    return nthreads > 1 ? (int) nthreads : 1;
+}
+
+inline static void
+reduce_parallel_op(shcoll_reduce_op_t op, void *dest, const void *src1,
+                   const void *src2, size_t nelems, size_t elem_size)
+{
+#ifdef _OPENMP
+    const int nthreads = reduce_threads_for(nelems * elem_size);
+
+    if (nthreads > 1) {
+        #pragma omp parallel num_threads(nthreads)
+        {
+            const size_t nchunks = (size_t) omp_get_num_threads();
+            const size_t chunk = (size_t) omp_get_thread_num();
+            const size_t begin = reduce_block_offset(chunk, nelems, nchunks);
+            const size_t end = reduce_block_offset(chunk + 1, nelems, nchunks);
+
+            op((char *) dest + begin * elem_size,
+               (const char *) src1 + begin * elem_size,
+               (const char *) src2 + begin * elem_size, end - begin);
+        }
+        return;
+    }
+#endif
+
+    op(dest, src1, src2, nelems);
+}
+
+inline static void
+reduce_parallel_memcpy(void *dest, const void *source, size_t nelems,
+                       size_t elem_size)
+{
+#ifdef _OPENMP
+    const int nthreads = reduce_threads_for(nelems * elem_size);
+
+    if (nthreads > 1) {
+        #pragma omp parallel num_threads(nthreads)
+        {
+            const size_t nchunks = (size_t) omp_get_num_threads();
+            const size_t chunk = (size_t) omp_get_thread_num();
+            const size_t begin = reduce_block_offset(chunk, nelems, nchunks);
+            const size_t end = reduce_block_offset(chunk + 1, nelems, nchunks);
+
+            memcpy((char *) dest + begin * elem_size,
+                   (const char *) source + begin * elem_size,
+                   (end - begin) * elem_size);
+        }
+        return;
+    }
+#endif
+
+    memcpy(dest, source, nelems * elem_size);
+}
+
+inline static void
+reduce_parallel_first_touch(void *buffer, size_t nelems, size_t elem_size)
+{
+#ifdef _OPENMP
+    const int nthreads = reduce_threads_for(nelems * elem_size);
+
+    if (nthreads > 1) {
+        #pragma omp parallel num_threads(nthreads)
+        {
+            const size_t nchunks = (size_t) omp_get_num_threads();
+            const size_t chunk = (size_t) omp_get_thread_num();
+            const size_t begin = reduce_block_offset(chunk, nelems, nchunks);
+            const size_t end = reduce_block_offset(chunk + 1, nelems, nchunks);
+
+            memset((char *) buffer + begin * elem_size, 0,
+                   (end - begin) * elem_size);
+        }
+    }
+#endif
+}
+
+/*
+ * The algorithms take size_t counts, the int versions forward to them
+ */
+
+#define REDUCE_INT_COUNT(_name, _type, _algorithm)                      \
+    void                                                                \
+    shcoll_##_name##_to_all_##_algorithm(_type *dest, const _type *source, \
+                                         int nreduce, int PE_start,     \
+                                         int logPE_stride, int PE_size, \
+                                         _type *pWrk, long *pSync)      \
+    {                                                                   \
+        shcoll_##_name##_to_all_##_algorithm##_size(dest, source,       \
+                                                    (size_t) nreduce,   \
+                                                    PE_start, logPE_stride, \
+                                                    PE_size, pWrk, pSync); \
+    }
+
+/*
+ * Returns the index of the group of parent's children that contains node
+ */
+inline static int
+knomial_tree_parent_group(int tree_size, int root, int k, int node,
+                          int parent)
+{
+    node_info_knomial_t parent_node;
+    int child_offset = 0;
+    int group;
+    int i;
+
+    get_node_info_knomial_root(tree_size, root, k, parent, &parent_node);
+
+    for (group = 0; group < parent_node.groups_num; group++) {
+        for (i = 0; i < parent_node.groups_sizes[group]; i++) {
+            if (parent_node.children[child_offset + i] == node) {
+                return group;
+            }
+        }
+
+        child_offset += parent_node.groups_sizes[group];
     }
 
+    return -1;
+}
+
 /*
  * Linear reduction implementation
  */
 
 #define REDUCE_HELPER_LINEAR(_name, _type, _op)                         \
     void                                                                \
-    shcoll_##_name##_to_all_linear(_type *dest, const _type *source,    \
-                                   int nreduce, int PE_start,           \
-                                   int logPE_stride, int PE_size,       \
-                                   _type *pWrk, long *pSync)            \
+    shcoll_##_name##_to_all_linear_size(_type *dest, const _type *source, \
+                                        size_t nreduce, int PE_start,   \
+                                        int logPE_stride, int PE_size,  \
+                                        _type *pWrk, long *pSync)       \
     {                                                                   \
         const int stride = 1 << logPE_stride;                           \
         const int me = shmem_my_pe();                                   \
@@ -54,14 +312,16 @@
                 exit(-1);                                               \
             }                                                           \
                                                                         \
-            memcpy(tmp_array, source, nbytes);                          \
-                                                                        \
+            /* Accumulate directly in dest, it may be the same as source */ \
             for (i = 1; i < PE_size; i++) {                             \
-                shmem_getmem(dest, source, nbytes, PE_start + i * stride); \
-                local_##_name##_reduce(tmp_array, tmp_array, dest, nreduce); \
+                shmem_getmem(tmp_array, source, nbytes, PE_start + i * stride); \
+                local_##_name##_reduce(dest, i == 1 ? source : dest, tmp_array, nreduce); \
+            }                                                           \
+                                                                        \
+            if (PE_size == 1 && dest != source) {                       \
+                memcpy(dest, source, nbytes);                           \
             }                                                           \
                                                                         \
-            memcpy(dest, tmp_array, nbytes);                            \
             free(tmp_array);                                            \
         }                                                               \
                                                                         \
@@ -71,218 +331,827 @@
                                  PE_start, PE_start,                    \
                                  logPE_stride, PE_size,                 \
                                  pSync + 1);                            \
-    }
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, linear)
 
 
     /*
      * Binomial reduction implementation
      */
 
+inline static void
+reduce_helper_binomial(void *dest, const void *source, size_t nreduce,
+                       size_t elem_size, shcoll_reduce_op_t op,
+                       int PE_start, int logPE_stride, int PE_size,
+                       long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+    int me_as = (me - PE_start) / stride;
+    int target_as;
+    size_t nbytes = elem_size * nreduce;
+    void *tmp_array = NULL;
+    unsigned mask = 0x1;
+    long old_pSync = SHCOLL_SYNC_VALUE;
+    long to_receive = 0;
+    long recv_mask;
+
+    tmp_array = malloc(nbytes);
+    if (!tmp_array) {
+        /* TODO: raise error */
+        fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);
+        exit(-1);
+    }
+
+    if (source != dest) {
+        memcpy(dest, source, nbytes);
+    }
+
+    /* Stop if all messages are received or if there are no more PE on right */
+    for (mask = 0x1;
+         !(me_as & mask) && ((me_as | mask) < PE_size);
+         mask <<= 1) {
+        to_receive |= mask;
+    }
+
+    /* TODO: fix if SHCOLL_SYNC_VALUE not 0 */
+    /* Wait until all messages are received */
+    while (to_receive != 0) {
+        memcpy(tmp_array, dest, nbytes);
+        shmem_long_wait_until(pSync, SHMEM_CMP_NE, old_pSync);
+        recv_mask = shmem_long_atomic_fetch(pSync, me);
+
+        recv_mask &= to_receive;
+        recv_mask ^= (recv_mask - 1) & recv_mask;
+
+        /* Get array and reduce */
+        target_as = (int) (me_as | recv_mask);
+        shmem_getmem(dest, dest, nbytes, PE_start + target_as * stride);
+
+        op(dest, dest, tmp_array, nreduce);
+
+        /* Mark as received */
+        to_receive &= ~recv_mask;
+        old_pSync |= recv_mask;
+    }
+
+    /* Notify parent */
+    if (me_as != 0) {
+        target_as = me_as & (me_as - 1);
+        shmem_long_atomic_add(pSync, me_as ^ target_as,
+                              PE_start + target_as * stride);
+    }
+
+    shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
+    shcoll_barrier_linear(PE_start, logPE_stride, PE_size, pSync + 1);
+
+    shcoll_broadcast8_binomial_tree(dest, dest, nbytes,
+                                    PE_start, PE_start,
+                                    logPE_stride, PE_size,
+                                    pSync + 2);
+
+    free(tmp_array);
+}
+
 #define REDUCE_HELPER_BINOMIAL(_name, _type, _op)                       \
     void                                                                \
-    shcoll_##_name##_to_all_binomial(_type *dest, const _type *source,  \
-                                     int nreduce,                       \
-                                     int PE_start, int logPE_stride,    \
-                                     int PE_size,                       \
-                                     _type *pWrk, long *pSync)          \
+    shcoll_##_name##_to_all_binomial_size(_type *dest, const _type *source, \
+                                          size_t nreduce, int PE_start, \
+                                          int logPE_stride, int PE_size, \
+                                          _type *pWrk, long *pSync)     \
+    {                                                                   \
+        reduce_helper_binomial(dest, source, nreduce, sizeof(_type),    \
+                               local_##_name##_reduce,                  \
+                               PE_start, logPE_stride, PE_size, pSync); \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, binomial)
+
+/*
+ * Pipelined tree reduction implementation
+ *
+ * Children push their partial results segment by segment into the
+ * parent's pWrk, which is used as a double buffer.  The parent combines one
+ * segment while the next one is in flight, and returns a credit to the
+ * child for every buffer it has freed.
+ */
+
+#define REDUCE_HELPER_PIPELINED(_name, _type, _op)                      \
+    inline static void                                                  \
+    reduce_##_name##_helper_pipelined(_type *dest, const _type *source, \
+                                      size_t nreduce, int tree_radix,   \
+                                      int PE_start, int logPE_stride,   \
+                                      int PE_size, _type *pWrk,         \
+                                      long *pSync)                      \
     {                                                                   \
         const int stride = 1 << logPE_stride;                           \
         const int me = shmem_my_pe();                                   \
-        int me_as = (me - PE_start) / stride;                           \
-        int target_as;                                                  \
-        size_t nbytes = sizeof(_type) * nreduce;                        \
-        _type *tmp_array = NULL;                                        \
-        unsigned mask = 0x1;                                            \
-        long old_pSync = SHCOLL_SYNC_VALUE;                             \
-        long to_receive = 0;                                            \
-        long recv_mask;                                                 \
+        const int me_as = (me - PE_start) / stride;                     \
                                                                         \
-        tmp_array = malloc(nbytes);                                     \
-        if (!tmp_array) {                                               \
-            /* TODO: raise error */                                     \
-            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
-            exit(-1);                                                   \
+        /* pWrk is guaranteed to hold at least this many elements */    \
+        const size_t wrk_nelems = nreduce / 2 + 1 > SHCOLL_REDUCE_MIN_WRKDATA_SIZE ? \
+                                  nreduce / 2 + 1 : SHCOLL_REDUCE_MIN_WRKDATA_SIZE; \
+        size_t segment_nelems = reduce_segment_size / sizeof(_type);    \
+        size_t nsegments;                                               \
+        size_t nbuffers;                                                \
+        size_t offset;                                                  \
+        size_t nelems;                                                  \
+        size_t i;                                                       \
+                                                                        \
+        /* pSync[0] counts credits received from the parent             \
+         * pSync[1] counts segments received from the current child */  \
+        long *credit_pSync = pSync;                                     \
+        long *segment_pSync = pSync + 1;                                \
+                                                                        \
+        node_info_knomial_t node;                                       \
+        int child_pe;                                                   \
+        int parent_pe;                                                  \
+        int j;                                                          \
+                                                                        \
+        if (segment_nelems > wrk_nelems / 2) {                          \
+            segment_nelems = wrk_nelems / 2;                            \
         }                                                               \
                                                                         \
-        if (source != dest) {                                           \
-            memcpy(dest, source, nbytes);                               \
+        if (segment_nelems == 0) {                                      \
+            segment_nelems = 1;                                         \
         }                                                               \
                                                                         \
-        /* Stop if all messages are received or if there are no more PE on right */ \
-        for (mask = 0x1;                                                \
-             !(me_as & mask) && ((me_as | mask) < PE_size);             \
-             mask <<= 1) {                                              \
-            to_receive |= mask;                                         \
+        nbuffers = wrk_nelems >= 2 * segment_nelems ? 2 : 1;            \
+        nsegments = (nreduce + segment_nelems - 1) / segment_nelems;    \
+                                                                        \
+        if (source != dest) {                                           \
+            memcpy(dest, source, nreduce * sizeof(_type));              \
         }                                                               \
                                                                         \
-        /* TODO: fix if SHCOLL_SYNC_VALUE not 0 */                      \
-        /* Wait until all messages are received */                      \
-        while (to_receive != 0) {                                       \
-            memcpy(tmp_array, dest, nbytes);                            \
-            shmem_long_wait_until(pSync, SHMEM_CMP_NE, old_pSync);      \
-            recv_mask = shmem_long_atomic_fetch(pSync, me);             \
+        get_node_info_knomial_root(PE_size, 0, tree_radix, me_as, &node); \
+                                                                        \
+        /* The last children have the smallest subtrees, so they are ready first */ \
+        for (j = node.children_num - 1; j >= 0; j--) {                  \
+            child_pe = PE_start + node.children[j] * stride;            \
+                                                                        \
+            /* Let the child fill all the buffers */                    \
+            shmem_long_atomic_add(credit_pSync, nbuffers, child_pe);    \
                                                                         \
-            recv_mask &= to_receive;                                    \
-            recv_mask ^= (recv_mask - 1) & recv_mask;                   \
+            for (i = 0; i < nsegments; i++) {                           \
+                offset = i * segment_nelems;                            \
+                nelems = nreduce - offset < segment_nelems ?            \
+                         nreduce - offset : segment_nelems;             \
                                                                         \
-            /* Get array and reduce */                                  \
-            target_as = (int) (me_as | recv_mask);                      \
-            shmem_getmem(dest, dest, nbytes, PE_start + target_as * stride); \
+                shmem_long_wait_until(segment_pSync, SHMEM_CMP_GE,      \
+                                      SHCOLL_SYNC_VALUE + i + 1);       \
                                                                         \
-            local_##_name##_reduce(dest, dest, tmp_array, nreduce);     \
+                local_##_name##_reduce(dest + offset, dest + offset,    \
+                                       pWrk + (i % nbuffers) * segment_nelems, \
+                                       nelems);                         \
                                                                         \
-            /* Mark as received */                                      \
-            to_receive &= ~recv_mask;                                   \
-            old_pSync |= recv_mask;                                     \
+                if (i + 1 == nsegments) {                               \
+                    shmem_long_p(segment_pSync, SHCOLL_SYNC_VALUE, me); \
+                }                                                       \
+                                                                        \
+                /* Buffer is free again */                              \
+                shmem_long_atomic_inc(credit_pSync, child_pe);          \
+            }                                                           \
         }                                                               \
                                                                         \
-        /* Notify parent */                                             \
-        if (me_as != 0) {                                               \
-            target_as = me_as & (me_as - 1);                            \
-            shmem_long_atomic_add(pSync, me_as ^ target_as,             \
-                                  PE_start + target_as * stride);       \
+        if (node.parent != -1) {                                        \
+            parent_pe = PE_start + node.parent * stride;                \
+                                                                        \
+            for (i = 0; i < nsegments; i++) {                           \
+                offset = i * segment_nelems;                            \
+                nelems = nreduce - offset < segment_nelems ?            \
+                         nreduce - offset : segment_nelems;             \
+                                                                        \
+                shmem_long_wait_until(credit_pSync, SHMEM_CMP_GE,       \
+                                      SHCOLL_SYNC_VALUE + i + 1);       \
+                                                                        \
+                shmem_putmem_nbi(pWrk + (i % nbuffers) * segment_nelems, \
+                                 dest + offset, nelems * sizeof(_type), parent_pe); \
+                shmem_fence();                                          \
+                shmem_long_p(segment_pSync, SHCOLL_SYNC_VALUE + i + 1, parent_pe); \
+            }                                                           \
+                                                                        \
+            /* Wait until the parent has consumed all the segments */   \
+            shmem_long_wait_until(credit_pSync, SHMEM_CMP_EQ,           \
+                                  SHCOLL_SYNC_VALUE + nsegments + nbuffers); \
+            shmem_long_p(credit_pSync, SHCOLL_SYNC_VALUE, me);          \
         }                                                               \
+    }                                                                   \
                                                                         \
-        shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);                     \
-        shcoll_barrier_linear(PE_start, logPE_stride, PE_size, pSync + 1); \
+    void                                                                \
+    shcoll_##_name##_to_all_binomial_pipelined_size(_type *dest, const _type *source, \
+                                                    size_t nreduce, int PE_start, \
+                                                    int logPE_stride, int PE_size, \
+                                                    _type *pWrk, long *pSync) \
+    {                                                                   \
+        reduce_##_name##_helper_pipelined(dest, source, nreduce, 2,     \
+                                          PE_start, logPE_stride, PE_size, \
+                                          pWrk, pSync);                 \
                                                                         \
         shcoll_broadcast8_binomial_tree(dest, dest,                     \
                                         nreduce * sizeof(_type),        \
                                         PE_start, PE_start,             \
                                         logPE_stride, PE_size,          \
                                         pSync + 2);                     \
+    }                                                                   \
                                                                         \
-        free(tmp_array);                                                \
-    }
+    REDUCE_INT_COUNT(_name, _type, binomial_pipelined)                  \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_to_all_knomial_pipelined_size(_type *dest, const _type *source, \
+                                                   size_t nreduce, int PE_start, \
+                                                   int logPE_stride, int PE_size, \
+                                                   _type *pWrk, long *pSync) \
+    {                                                                   \
+        reduce_##_name##_helper_pipelined(dest, source, nreduce,        \
+                                          knomial_tree_radix_reduce,    \
+                                          PE_start, logPE_stride, PE_size, \
+                                          pWrk, pSync);                 \
+                                                                        \
+        shcoll_broadcast8_knomial_tree(dest, dest,                      \
+                                       nreduce * sizeof(_type),         \
+                                       PE_start, PE_start,              \
+                                       logPE_stride, PE_size,           \
+                                       pSync + 2);                      \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, knomial_pipelined)
 
 /*
  * Recursive doubling implementation
+ *
+ * The engine takes an operator with a context, so that an operator that
+ * depends on the call, such as the one of a batch, does not need any global
+ * state.  reduce_apply_op runs a plain operator given as the context.
  */
 
+typedef void (*reduce_ctx_op_t)(const void *ctx, void *dest, const void *src1,
+                                const void *src2, size_t nelems);
+
+static void
+reduce_apply_op(const void *ctx, void *dest, const void *src1, const void *src2,
+                size_t nelems)
+{
+    (*(const shcoll_reduce_op_t *) ctx)(dest, src1, src2, nelems);
+}
+
+inline static void
+reduce_helper_rec_dbl_strided_ctx(void *dest, const void *source, size_t nreduce,
+                                  size_t elem_size, reduce_ctx_op_t op,
+                                  const void *op_ctx,
+                                  int PE_start, int stride, int PE_size,
+                                  long *pSync)
+{
+    const int me = shmem_my_pe();
+    int peer;
+
+    size_t nbytes = nreduce * elem_size;
+
+    /* Get my index in the active set */
+    int me_as = (me - PE_start) / stride;
+    int mask;
+
+    int xchg_peer_p2s;
+    int xchg_peer_as;
+    int xchg_peer_pe;
+
+    /* Power 2 set */
+    int me_p2s;
+    int p2s_size;
+
+    void *tmp_array = NULL;
+
+    /* Partial result, either source, tmp_array or dest */
+    const void *acc = source;
+
+    /* Find the greatest power of 2 lower than PE_size */
+    for (p2s_size = 1; p2s_size * 2 <= PE_size; p2s_size *= 2);
+
+    /* Check if the current PE belongs to the power 2 set */
+    me_p2s = me_as * p2s_size / PE_size;
+    if ((me_p2s * PE_size + p2s_size - 1) / p2s_size != me_as) {
+        me_p2s = -1;
+    }
+
+    /* If current PE belongs to the power 2 set, it will need temporary buffer */
+    if (me_p2s != -1 && p2s_size > 1) {
+        tmp_array = malloc(nbytes);
+        if (tmp_array == NULL) {
+            /* TODO: raise error */
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);
+            exit(-1);
+        }
+    }
+
+    /* Check if the current PE should wait/send data to the peer */
+    if (me_p2s == -1) {
+        /* Notify peer that the data is ready */
+        peer = PE_start + (me_as - 1) * stride;
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE + 1, peer);
+    } else if ((me_as + 1) * p2s_size / PE_size == me_p2s) {
+        /* We should wait for the data to be ready */
+        peer = PE_start + (me_as + 1) * stride;
+
+        shmem_long_wait_until(pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
+
+        /* Get the array and reduce */
+        shmem_getmem(tmp_array, source, nbytes, peer);
+        op(op_ctx, tmp_array, tmp_array, source, nreduce);
+        acc = tmp_array;
+    } else if (dest == source && p2s_size > 1) {
+        /* In place, the peers overwrite dest in the first round */
+        memcpy(tmp_array, source, nbytes);
+        acc = tmp_array;
+    }
+
+    /* If the current PE belongs to the power 2 set, do recursive doubling */
+    if (me_p2s != -1) {
+        int i;
+
+        for (mask = 0x1, i = 1; mask < p2s_size; mask <<= 1, i++) {
+            xchg_peer_p2s = me_p2s ^ mask;
+            xchg_peer_as = (xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size;
+            xchg_peer_pe = PE_start + xchg_peer_as * stride;
+
+            /* Notify the peer PE that current PE is ready to accept the data */
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe);
+
+            /* Wait until the peer PE is ready to accept the data */
+            shmem_long_wait_until(pSync + i, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE);
+
+            /* Send the data to the peer */
+            shmem_putmem(dest, acc, nbytes, xchg_peer_pe);
+            shmem_fence();
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 2, xchg_peer_pe);
+
+            /* Wait until the data is received and do local reduce, the last
+             * round accumulates directly in dest */
+            shmem_long_wait_until(pSync + i, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + 1);
+            if (mask << 1 >= p2s_size) {
+                op(op_ctx, dest, acc, dest, nreduce);
+                acc = dest;
+            } else {
+                op(op_ctx, tmp_array, acc, dest, nreduce);
+                acc = tmp_array;
+            }
+
+            /* Reset the pSync for the current round */
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);
+        }
+
+        if (acc != dest) {
+            memcpy(dest, acc, nbytes);
+        }
+    }
+
+    if (me_p2s == -1) {
+        /* Wait to get the data from a PE that is in the power 2 set */
+        shmem_long_wait_until(pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
+    } else if ((me_as + 1) * p2s_size / PE_size == me_p2s) {
+        /* Send data to peer PE that is outside the power 2 set */
+        peer = PE_start + (me_as + 1) * stride;
+
+        shmem_putmem(dest, dest, nbytes, peer);
+        shmem_fence();
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE + 1, peer);
+    }
+
+    if (tmp_array != NULL) {
+        free(tmp_array);
+    }
+}
+
+inline static void
+reduce_helper_rec_dbl_strided(void *dest, const void *source, size_t nreduce,
+                              size_t elem_size, shcoll_reduce_op_t op,
+                              int PE_start, int stride, int PE_size,
+                              long *pSync)
+{
+    reduce_helper_rec_dbl_strided_ctx(dest, source, nreduce, elem_size,
+                                      reduce_apply_op, &op,
+                                      PE_start, stride, PE_size, pSync);
+}
+
+inline static void
+reduce_helper_rec_dbl(void *dest, const void *source, size_t nreduce,
+                      size_t elem_size, shcoll_reduce_op_t op,
+                      int PE_start, int logPE_stride, int PE_size,
+                      long *pSync)
+{
+    reduce_helper_rec_dbl_strided(dest, source, nreduce, elem_size, op,
+                                  PE_start, 1 << logPE_stride, PE_size, pSync);
+}
+
 #define REDUCE_HELPER_REC_DBL(_name, _type, _op)                        \
     void                                                                \
-    shcoll_##_name##_to_all_rec_dbl(_type *dest, const _type *source,   \
-                                    int nreduce, int PE_start,          \
-                                    int logPE_stride, int PE_size,      \
-                                    _type *pWrk, long *pSync)           \
+    shcoll_##_name##_to_all_rec_dbl_size(_type *dest, const _type *source, \
+                                         size_t nreduce, int PE_start,  \
+                                         int logPE_stride, int PE_size, \
+                                         _type *pWrk, long *pSync)      \
+    {                                                                   \
+        reduce_helper_rec_dbl(dest, source, nreduce, sizeof(_type),     \
+                              local_##_name##_reduce,                   \
+                              PE_start, logPE_stride, PE_size, pSync);  \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, rec_dbl)
+
+/*
+ * Recursive multiplying (radix-k) implementation
+ *
+ * The largest power of k not greater than PE_size forms the "power k set",
+ * the remaining PEs are followers of the closest member on their left.  In
+ * every round, a member gets the partial results of its k - 1 peers at once.
+ */
+
+#define REDUCE_HELPER_REC_MULT(_name, _type, _op)                       \
+    void                                                                \
+    shcoll_##_name##_to_all_rec_mult_size(_type *dest, const _type *source, \
+                                          size_t nreduce, int PE_start, \
+                                          int logPE_stride, int PE_size, \
+                                          _type *pWrk, long *pSync)     \
     {                                                                   \
         const int stride = 1 << logPE_stride;                           \
         const int me = shmem_my_pe();                                   \
-        int peer;                                                       \
+        const int me_as = (me - PE_start) / stride;                     \
+        const int k = rec_mult_radix_reduce;                            \
+        const size_t nbytes = nreduce * sizeof(_type);                  \
                                                                         \
-        size_t nbytes = nreduce * sizeof(_type);                        \
+        /* pSync[0] is used by followers and their leader,              \
+         * pSync[1 + round] counts peers that are ready to be read,     \
+         * pSync[1 + PE_SIZE_LOG + round] counts peers that have read */ \
+        long *fold_pSync = pSync;                                       \
+        long *ready_pSync = pSync + 1;                                  \
+        long *ack_pSync = pSync + 1 + PE_SIZE_LOG;                      \
                                                                         \
-        /* Get my index in the active set */                            \
-        int me_as = (me - PE_start) / stride;                           \
-        int mask;                                                       \
+        /* Power k set */                                               \
+        int me_pks;                                                     \
+        int pks_size;                                                   \
                                                                         \
-        int xchg_peer_p2s;                                              \
-        int xchg_peer_as;                                               \
-        int xchg_peer_pe;                                               \
+        int leader_as;                                                  \
+        int next_leader_as;                                             \
+        int nfollowers;                                                 \
                                                                         \
-        /* Power 2 set */                                               \
-        int me_p2s;                                                     \
-        int p2s_size;                                                   \
+        int distance;                                                   \
+        int round;                                                      \
+        int digit;                                                      \
+        int peer_pe;                                                    \
+        int j;                                                          \
                                                                         \
         _type *tmp_array = NULL;                                        \
+        _type *recv_arrays = NULL;                                      \
                                                                         \
-        /* Find the greatest power of 2 lower than PE_size */           \
-        for (p2s_size = 1; p2s_size * 2 <= PE_size; p2s_size *= 2);     \
+        /* Find the greatest power of k lower than PE_size */           \
+        for (pks_size = 1; pks_size * k <= PE_size; pks_size *= k);     \
                                                                         \
-        /* Check if the current PE belongs to the power 2 set */        \
-        me_p2s = me_as * p2s_size / PE_size;                            \
-        if ((me_p2s * PE_size + p2s_size - 1) / p2s_size != me_as) {    \
-            me_p2s = -1;                                                \
+        /* Find the leader (member of the power k set) of current PE */ \
+        me_pks = me_as * pks_size / PE_size;                            \
+        leader_as = (me_pks * PE_size + pks_size - 1) / pks_size;       \
+        next_leader_as = ((me_pks + 1) * PE_size + pks_size - 1) / pks_size; \
+                                                                        \
+        if (leader_as != me_as) {                                       \
+            /* Notify the leader that the data is ready */              \
+            peer_pe = PE_start + leader_as * stride;                    \
+            shmem_long_atomic_inc(fold_pSync, peer_pe);                 \
+                                                                        \
+            /* Wait for the result */                                   \
+            shmem_long_wait_until(fold_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);            \
+            return;                                                     \
         }                                                               \
                                                                         \
-        /* If current PE belongs to the power 2 set, it will need temporary buffer */ \
-        if (me_p2s != -1) {                                             \
-            tmp_array = malloc(nreduce * sizeof(_type));                \
-            if (tmp_array == NULL) {                                    \
-                /* TODO: raise error */                                 \
-                fprintf(stderr, "PE %d: Cannot allocate memory!\n", me); \
-                exit(-1);                                               \
-            }                                                           \
+        nfollowers = next_leader_as - leader_as - 1;                    \
+                                                                        \
+        tmp_array = malloc(nbytes);                                     \
+        recv_arrays = malloc(nbytes * (nfollowers > k - 1 ? nfollowers : k - 1)); \
+        if (tmp_array == NULL || recv_arrays == NULL) {                 \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
         }                                                               \
                                                                         \
-        /* Check if the current PE should wait/send data to the peer */ \
-        if (me_p2s == -1) {                                             \
-            /* Notify peer that the data is ready */                    \
-            peer = PE_start + (me_as - 1) * stride;                     \
-            shmem_long_p(pSync, SHCOLL_SYNC_VALUE + 1, peer);           \
-        } else if ((me_as + 1) * p2s_size / PE_size == me_p2s) {        \
-            /* We should wait for the data to be ready */               \
-            peer = PE_start + (me_as + 1) * stride;                     \
+        /* Fold the data of the followers */                            \
+        if (nfollowers != 0) {                                          \
+            shmem_long_wait_until(fold_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + nfollowers); \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);            \
                                                                         \
-            shmem_long_wait_until(pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
-            shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);                 \
+            for (j = 0; j < nfollowers; j++) {                          \
+                shmem_getmem_nbi(recv_arrays + j * nreduce, source, nbytes, \
+                                 PE_start + (me_as + 1 + j) * stride);  \
+            }                                                           \
+            shmem_quiet();                                              \
+        }                                                               \
                                                                         \
-            /* Get the array and reduce */                              \
-            shmem_getmem(dest, source, nbytes, peer);                   \
-            local_##_name##_reduce(tmp_array, dest, source, nreduce);   \
-        } else {                                                        \
-            memcpy(tmp_array, source, nbytes);                          \
+        memcpy(tmp_array, source, nbytes);                              \
+        for (j = 0; j < nfollowers; j++) {                              \
+            local_##_name##_reduce(tmp_array, tmp_array, recv_arrays + j * nreduce, nreduce); \
         }                                                               \
                                                                         \
-        /* If the current PE belongs to the power 2 set, do recursive doubling */ \
-        if (me_p2s != -1) {                                             \
-            int i;                                                      \
+        /* Recursive multiplying between the members of power k set */  \
+        for (distance = 1, round = 0; distance < pks_size; distance *= k, round++) { \
+            digit = (me_pks / distance) % k;                            \
                                                                         \
-            for (mask = 0x1, i = 1; mask < p2s_size; mask <<= 1, i++) { \
-                xchg_peer_p2s = me_p2s ^ mask;                          \
-                xchg_peer_as = (xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size; \
-                xchg_peer_pe = PE_start + xchg_peer_as * stride;        \
+            /* Partial result of the current PE is ready to be read */  \
+            memcpy(dest, tmp_array, nbytes);                            \
                                                                         \
-                /* Notify the peer PE that current PE is ready to accept the data */ \
-                shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe); \
+            for (j = 0; j < k; j++) {                                   \
+                if (j != digit) {                                       \
+                    peer_pe = PE_start + stride *                       \
+                        (((me_pks + (j - digit) * distance) * PE_size + pks_size - 1) / pks_size); \
+                    shmem_long_atomic_inc(ready_pSync + round, peer_pe); \
+                }                                                       \
+            }                                                           \
                                                                         \
-                /* Wait until the peer PE is ready to accept the data */ \
-                shmem_long_wait_until(pSync + i, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE); \
+            shmem_long_wait_until(ready_pSync + round, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + k - 1); \
+            shmem_long_p(ready_pSync + round, SHCOLL_SYNC_VALUE, me);   \
                                                                         \
-                /* Send the data to the peer */                         \
-                shmem_putmem(dest, tmp_array, nbytes, xchg_peer_pe);    \
-                shmem_fence();                                          \
-                shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 2, xchg_peer_pe); \
+            /* Get the partial results of all the peers at once */      \
+            for (j = 0; j < k; j++) {                                   \
+                if (j != digit) {                                       \
+                    peer_pe = PE_start + stride *                       \
+                        (((me_pks + (j - digit) * distance) * PE_size + pks_size - 1) / pks_size); \
+                    shmem_getmem_nbi(recv_arrays + (j < digit ? j : j - 1) * nreduce, \
+                                     dest, nbytes, peer_pe);            \
+                }                                                       \
+            }                                                           \
+            shmem_quiet();                                              \
                                                                         \
-                /* Wait until the data is received and do local reduce */ \
-                shmem_long_wait_until(pSync + i, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + 1); \
-                local_##_name##_reduce(tmp_array, tmp_array, dest, nreduce); \
+            for (j = 0; j < k; j++) {                                   \
+                if (j != digit) {                                       \
+                    peer_pe = PE_start + stride *                       \
+                        (((me_pks + (j - digit) * distance) * PE_size + pks_size - 1) / pks_size); \
+                    shmem_long_atomic_inc(ack_pSync + round, peer_pe);  \
+                }                                                       \
+            }                                                           \
                                                                         \
-                /* Reset the pSync for the current round */             \
-                shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);         \
+            for (j = 0; j < k - 1; j++) {                               \
+                local_##_name##_reduce(tmp_array, tmp_array, recv_arrays + j * nreduce, nreduce); \
             }                                                           \
                                                                         \
-            memcpy(dest, tmp_array, nbytes);                            \
+            /* Wait until the peers have read the partial result */     \
+            shmem_long_wait_until(ack_pSync + round, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + k - 1); \
+            shmem_long_p(ack_pSync + round, SHCOLL_SYNC_VALUE, me);     \
         }                                                               \
                                                                         \
-        if (me_p2s == -1) {                                             \
-            /* Wait to get the data from a PE that is in the power 2 set */ \
-            shmem_long_wait_until(pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
-            shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);                 \
-        } else if ((me_as + 1) * p2s_size / PE_size == me_p2s) {        \
-            /* Send data to peer PE that is outside the power 2 set */  \
-            peer = PE_start + (me_as + 1) * stride;                     \
+        memcpy(dest, tmp_array, nbytes);                                \
                                                                         \
-            shmem_putmem(dest, dest, nbytes, peer);                     \
-            shmem_fence();                                              \
-            shmem_long_p(pSync, SHCOLL_SYNC_VALUE + 1, peer);           \
+        /* Send the result to the followers */                          \
+        for (j = 0; j < nfollowers; j++) {                              \
+            peer_pe = PE_start + (me_as + 1 + j) * stride;              \
+            shmem_putmem_nbi(dest, dest, nbytes, peer_pe);              \
         }                                                               \
                                                                         \
-        if (tmp_array != NULL) {                                        \
-            free(tmp_array);                                            \
+        shmem_fence();                                                  \
+                                                                        \
+        for (j = 0; j < nfollowers; j++) {                              \
+            peer_pe = PE_start + (me_as + 1 + j) * stride;              \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE + 1, peer_pe);   \
         }                                                               \
-    }
-
-/*
+                                                                        \
+        free(tmp_array);                                                \
+        free(recv_arrays);                                              \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, rec_mult)
+
+/*
  * Rabenseifner reduction implementation
  */
 
+inline static void
+reduce_helper_rabenseifner_strided(void *dest, const void *source, size_t nreduce,
+                                   size_t elem_size, shcoll_reduce_op_t op,
+                                   int PE_start, int stride, int PE_size,
+                                   long *pSync)
+{
+    const int me = shmem_my_pe();
+
+    int me_as = (me - PE_start) / stride;
+    int peer;
+    size_t i;
+    const size_t nelems = (const size_t) nreduce;
+
+    int block_idx_begin;
+    int block_idx_end;
+
+    ptrdiff_t block_offset;
+    ptrdiff_t next_block_offset;
+    size_t block_nelems;
+
+    int xchg_peer_p2s;
+    int xchg_peer_as;
+    int xchg_peer_pe;
+
+    /* Power 2 set */
+    int me_p2s;
+    int p2s_size;
+    int log_p2s_size;
+
+    int distance;
+    void *tmp_array = NULL;
+
+    char *dest_bytes = dest;
+    const char *source_bytes = source;
+
+    /* Find the greatest power of 2 lower than PE_size */
+    for (p2s_size = 1, log_p2s_size = 0; p2s_size * 2 <= PE_size; p2s_size *= 2, log_p2s_size++);
+
+    /* Check if the current PE belongs to the power 2 set */
+    me_p2s = me_as * p2s_size / PE_size;
+    if ((me_p2s * PE_size + p2s_size - 1) / p2s_size != me_as) {
+        me_p2s = -1;
+    }
+
+    /* The data of the peers is received in the temporary buffer, so that
+     * dest is never written before source has been read */
+    tmp_array = malloc((nelems / 2 + 1) * elem_size);
+    if (tmp_array == NULL) {
+        /* TODO: raise error */
+        fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);
+        exit(-1);
+    }
+
+    reduce_parallel_first_touch(tmp_array, nelems / 2 + 1, elem_size);
+
+    /* Check if the current PE should wait/send data to the peer */
+    if (me_p2s == -1) {
+        /* Notify peer that the data is ready */
+        peer = PE_start + (me_as - 1) * stride;
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE + 1, peer);
+
+        /* Wait until the data on peer node is ready and get the data (upper half of the array) */
+        block_offset = nelems / 2;
+        block_nelems = (size_t) (nelems - block_offset);
+
+        shmem_long_wait_until(pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
+        shmem_getmem(tmp_array, source_bytes + block_offset * elem_size, block_nelems * elem_size, peer);
+
+        /* Reduce the upper half of the array */
+        reduce_parallel_op(op, dest_bytes + block_offset * elem_size, source_bytes + block_offset * elem_size,
+                           tmp_array, block_nelems, elem_size);
+
+        /* Send the upper half of the array to peer */
+        shmem_putmem(dest_bytes + block_offset * elem_size, dest_bytes + block_offset * elem_size, block_nelems * elem_size, peer);
+        shmem_fence();
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE + 2, peer);
+    } else if ((me_as + 1) * p2s_size / PE_size == me_p2s) {
+        /* Notify peer that the data is ready */
+        peer = PE_start + (me_as + 1) * stride;
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE + 1, peer);
+
+        /* Wait until the data on peer node is ready and get the data (lower half of the array) */
+        block_offset = 0;
+        block_nelems = (size_t) (nelems / 2 - block_offset);
+
+        shmem_long_wait_until(pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE);
+        shmem_getmem(tmp_array, source, block_nelems * elem_size, peer);
+
+        /* Do local reduce */
+        reduce_parallel_op(op, dest, source, tmp_array, block_nelems, elem_size);
+
+        /* Wait until the upper half is received from peer */
+        shmem_long_wait_until(pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + 1);
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
+    } else if (p2s_size == 1 && dest != source) {
+        reduce_parallel_memcpy(dest, source, nelems, elem_size);
+    }
+
+    /* For folded nodes in the power 2 set, dest contains data that should be
+     * reduced, the others still read it from source in the first round */
+
+    /* Do reduce scatter with the nodes in power 2 set */
+    if (me_p2s != -1) {
+        block_idx_begin = 0;
+        block_idx_end = p2s_size;
+
+        for (distance = 1, i = 1; distance < p2s_size; distance <<= 1, i++) {
+            xchg_peer_p2s = ((me_p2s & distance) == 0) ? me_p2s + distance : me_p2s - distance;
+            xchg_peer_as = (xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size;
+            xchg_peer_pe = PE_start + xchg_peer_as * stride;
+
+            /* Notify the peer PE that the data is ready to be read */
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe);
+
+            /* Check if the current PE is responsible for lower half of upper half of the vector */
+            if ((me_p2s & distance) == 0) {
+                block_idx_end = (block_idx_begin + block_idx_end) / 2;
+            } else {
+                block_idx_begin = (block_idx_begin + block_idx_end) / 2;
+            }
+
+            block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size);
+            next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size);
+            block_nelems = (size_t) (next_block_offset - block_offset);
+
+            /* Wait until the data on peer PE is ready to be read and get the data */
+            shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1);
+            shmem_getmem(tmp_array, (distance == 1 && (xchg_peer_as + 1) * p2s_size / PE_size != xchg_peer_p2s ?
+                                     source_bytes : dest_bytes) + block_offset * elem_size,
+                         block_nelems * elem_size, xchg_peer_pe);
+
+            /* Notify the peer PE that the data transfer has completed successfully */
+            shmem_fence();
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 2, xchg_peer_pe);
+
+            /* Do local reduce */
+            reduce_parallel_op(op, dest_bytes + block_offset * elem_size,
+                               (distance == 1 && (me_as + 1) * p2s_size / PE_size != me_p2s ?
+                                source_bytes : dest_bytes) + block_offset * elem_size,
+                               tmp_array, block_nelems, elem_size);
+
+            /* Wait until the peer PE has read the data */
+            shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 2);
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);
+        }
+    }
+
+    /* For nodes in the power 2 set, destination will contain the reduced block */
+
+    /* Do collect with the nodes in power 2 set */
+    if (me_p2s != -1) {
+        block_offset = 0;
+        block_idx_begin = reverse_bits(me_p2s, log_p2s_size);
+        block_idx_end = block_idx_begin + 1;
+
+        for (distance = p2s_size / 2, i = sizeof(int) * CHAR_BIT + 1; distance > 0; distance >>= 1, i++) {
+            xchg_peer_p2s = ((me_p2s & distance) == 0) ? me_p2s + distance : me_p2s - distance;
+            xchg_peer_as = (xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size;
+            xchg_peer_pe = PE_start + xchg_peer_as * stride;
+
+            block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size);
+            next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size);
+            block_nelems = (size_t) (next_block_offset - block_offset);
+
+            shmem_putmem(dest_bytes + block_offset * elem_size, dest_bytes + block_offset * elem_size,
+                         block_nelems * elem_size, xchg_peer_pe);
+            shmem_fence();
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe);
+
+            /* Wait until the data has arrived from exchange the peer PE */
+            shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1);
+            shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);
+
+            /* Updated the block range */
+            if ((me_p2s & distance) == 0) {
+                block_idx_end += (block_idx_end - block_idx_begin);
+            } else {
+                block_idx_begin -= (block_idx_end - block_idx_begin);
+            }
+        }
+    }
+
+    /* Check if the current PE should wait/send data to the peer */
+    if (me_p2s == -1) {
+        /* Wait until the peer PE sends the data */
+        shmem_long_wait_until(pSync + 1, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1);
+        shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE, me);
+    } else if ((me_as + 1) * p2s_size / PE_size == me_p2s) {
+        peer = PE_start + (me_as + 1) * stride;
+        shmem_putmem(dest, dest, nelems * elem_size, peer);
+        shmem_fence();
+        shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE + 1, peer);
+    }
+
+    if (tmp_array != NULL) {
+        free(tmp_array);
+    }
+}
+
+inline static void
+reduce_helper_rabenseifner(void *dest, const void *source, size_t nreduce,
+                           size_t elem_size, shcoll_reduce_op_t op,
+                           int PE_start, int logPE_stride, int PE_size,
+                           long *pSync)
+{
+    reduce_helper_rabenseifner_strided(dest, source, nreduce, elem_size, op,
+                                       PE_start, 1 << logPE_stride, PE_size, pSync);
+}
+
 #define REDUCE_HELPER_RABENSEIFNER(_name, _type, _op)                   \
     void                                                                \
-    shcoll_##_name##_to_all_rabenseifner(_type *dest, const _type *source, \
-                                         int nreduce, int PE_start,     \
-                                         int logPE_stride, int PE_size, \
-                                         _type *pWrk, long *pSync)      \
+    shcoll_##_name##_to_all_rabenseifner_size(_type *dest, const _type *source, \
+                                              size_t nreduce, int PE_start, \
+                                              int logPE_stride, int PE_size, \
+                                              _type *pWrk, long *pSync) \
+    {                                                                   \
+        reduce_helper_rabenseifner(dest, source, nreduce, sizeof(_type), \
+                                   local_##_name##_reduce,              \
+                                   PE_start, logPE_stride, PE_size,     \
+                                   pSync);                              \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, rabenseifner)
+
+
+#define REDUCE_HELPER_RABENSEIFNER2(_name, _type, _op)                  \
+    void                                                                \
+    shcoll_##_name##_to_all_rabenseifner2_size(_type *dest, const _type *source, \
+                                               size_t nreduce, int PE_start, \
+                                               int logPE_stride, int PE_size, \
+                                               _type *pWrk, long *pSync) \
     {                                                                   \
         const int stride = 1 << logPE_stride;                           \
         const int me = shmem_my_pe();                                   \
@@ -290,8 +1159,8 @@
         int me_as = (me - PE_start) / stride;                           \
         int peer;                                                       \
         size_t i;                                                       \
-        const size_t nelems = (const size_t) nreduce;                   \
                                                                         \
+        const size_t nelems = (const size_t) nreduce;                   \
         int block_idx_begin;                                            \
         int block_idx_end;                                              \
                                                                         \
@@ -303,6 +1172,10 @@
         int xchg_peer_as;                                               \
         int xchg_peer_pe;                                               \
                                                                         \
+        int ring_peer_p2s;                                              \
+        int ring_peer_as;                                               \
+        int ring_peer_pe;                                               \
+                                                                        \
         /* Power 2 set */                                               \
         int me_p2s;                                                     \
         int p2s_size;                                                   \
@@ -311,6 +1184,8 @@
         int distance;                                                   \
         _type *tmp_array = NULL;                                        \
                                                                         \
+        long *collect_pSync = pSync + (1 + sizeof(int) * CHAR_BIT);     \
+                                                                        \
         /* Find the greatest power of 2 lower than PE_size */           \
         for (p2s_size = 1, log_p2s_size = 0; p2s_size * 2 <= PE_size; p2s_size *= 2, log_p2s_size++); \
                                                                         \
@@ -320,16 +1195,17 @@
             me_p2s = -1;                                                \
         }                                                               \
                                                                         \
-        /* If current PE belongs to the power 2 set, it will need temporary buffer */ \
-        if (me_p2s != -1) {                                             \
-            tmp_array = malloc((nelems / 2 + 1) * sizeof(_type));       \
-            if (tmp_array == NULL) {                                    \
-                /* TODO: raise error */                                 \
-                fprintf(stderr, "PE %d: Cannot allocate memory!\n", me); \
-                exit(-1);                                               \
-            }                                                           \
+        /* The data of the peers is received in the temporary buffer, so that \
+         * dest is never written before source has been read */         \
+        tmp_array = malloc((nelems / 2 + 1) * sizeof(_type));           \
+        if (tmp_array == NULL) {                                        \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
         }                                                               \
                                                                         \
+        reduce_parallel_first_touch(tmp_array, nelems / 2 + 1, sizeof(_type)); \
+                                                                        \
         /* Check if the current PE should wait/send data to the peer */ \
         if (me_p2s == -1) {                                             \
             /* Notify peer that the data is ready */                    \
@@ -341,10 +1217,12 @@
             block_nelems = (size_t) (nelems - block_offset);            \
                                                                         \
             shmem_long_wait_until(pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
-            shmem_getmem(dest + block_offset, source + block_offset, block_nelems * sizeof(_type), peer); \
+            shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);                 \
+            shmem_getmem(tmp_array, source + block_offset, block_nelems * sizeof(_type), peer); \
                                                                         \
             /* Reduce the upper half of the array */                    \
-            local_##_name##_reduce(dest + block_offset, dest + block_offset, source + block_offset, block_nelems); \
+            reduce_parallel_op(local_##_name##_reduce, dest + block_offset, source + block_offset, \
+                               tmp_array, block_nelems, sizeof(_type)); \
                                                                         \
             /* Send the upper half of the array to peer */              \
             shmem_putmem(dest + block_offset, dest + block_offset, block_nelems * sizeof(_type), peer); \
@@ -360,16 +1238,17 @@
             block_nelems = (size_t) (nelems / 2 - block_offset);        \
                                                                         \
             shmem_long_wait_until(pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE); \
-            shmem_getmem(dest, source, block_nelems * sizeof(_type), peer); \
+            shmem_getmem(tmp_array, source, block_nelems * sizeof(_type), peer); \
                                                                         \
             /* Do local reduce */                                       \
-            local_##_name##_reduce(dest, dest, source, block_nelems);   \
+            reduce_parallel_op(local_##_name##_reduce, dest, source, tmp_array, \
+                               block_nelems, sizeof(_type));            \
                                                                         \
             /* Wait until the upper half is received from peer */       \
             shmem_long_wait_until(pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + 1); \
             shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);                 \
-        } else {                                                        \
-            memcpy(dest, source, nelems * sizeof(_type));               \
+        } else if (dest != source) {                                    \
+            reduce_parallel_memcpy(dest, source, nelems, sizeof(_type)); \
         }                                                               \
                                                                         \
         /* For nodes in the power 2 set, dest contains data that should be reduced */ \
@@ -394,9 +1273,8 @@
                     block_idx_begin = (block_idx_begin + block_idx_end) / 2; \
                 }                                                       \
                                                                         \
-                /* TODO: possible overflow */                           \
-                block_offset = (block_idx_begin * nelems) / p2s_size;   \
-                next_block_offset = (block_idx_end * nelems) / p2s_size; \
+                block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+                next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
                 block_nelems = (size_t) (next_block_offset - block_offset); \
                                                                         \
                 /* Wait until the data on peer PE is ready to be read and get the data */ \
@@ -408,7 +1286,8 @@
                 shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 2, xchg_peer_pe); \
                                                                         \
                 /* Do local reduce */                                   \
-                local_##_name##_reduce(dest + block_offset, dest + block_offset, tmp_array, block_nelems); \
+                reduce_parallel_op(local_##_name##_reduce, dest + block_offset, dest + block_offset, \
+                                   tmp_array, block_nelems, sizeof(_type)); \
                                                                         \
                 /* Wait until the peer PE has read the data */          \
                 shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 2); \
@@ -420,36 +1299,27 @@
                                                                         \
         /* Do collect with the nodes in power 2 set */                  \
         if (me_p2s != -1) {                                             \
-            block_offset = 0;                                           \
-            block_idx_begin = reverse_bits(me_p2s, log_p2s_size);       \
-            block_idx_end = block_idx_begin + 1;                        \
+            ring_peer_p2s = (me_p2s + 1) % p2s_size;                    \
+            ring_peer_as = (ring_peer_p2s * PE_size + p2s_size - 1) / p2s_size; \
+            ring_peer_pe = PE_start + ring_peer_as * stride;            \
                                                                         \
-            for (distance = p2s_size / 2, i = sizeof(int) * CHAR_BIT + 1; distance > 0; distance >>= 1, i++) { \
-                xchg_peer_p2s = ((me_p2s & distance) == 0) ? me_p2s + distance : me_p2s - distance; \
-                xchg_peer_as = (xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size; \
-                xchg_peer_pe = PE_start + xchg_peer_as * stride;        \
+            for (i = 0; i < p2s_size; i++) {                            \
+                block_idx_begin = reverse_bits((int) ((me_p2s - i + p2s_size) % p2s_size), log_p2s_size); \
+                block_idx_end = block_idx_begin + 1;                    \
                                                                         \
-                /* TODO: possible overflow */                           \
-                block_offset = (block_idx_begin * nelems) / p2s_size;   \
-                next_block_offset = (block_idx_end * nelems) / p2s_size; \
+                block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+                next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
                 block_nelems = (size_t) (next_block_offset - block_offset); \
                                                                         \
-                shmem_putmem(dest + block_offset, dest + block_offset,  \
-                             block_nelems * sizeof(_type), xchg_peer_pe); \
+                shmem_putmem_nbi(dest + block_offset, dest + block_offset, \
+                                 block_nelems * sizeof(_type), ring_peer_pe); \
                 shmem_fence();                                          \
-                shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe); \
-                                                                        \
-                /* Wait until the data has arrived from exchange the peer PE */ \
-                shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1); \
-                shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);         \
+                shmem_long_p(collect_pSync, SHCOLL_SYNC_VALUE + i + 1, ring_peer_pe); \
                                                                         \
-                /* Updated the block range */                           \
-                if ((me_p2s & distance) == 0) {                         \
-                    block_idx_end += (block_idx_end - block_idx_begin); \
-                } else {                                                \
-                    block_idx_begin -= (block_idx_end - block_idx_begin); \
-                }                                                       \
+                shmem_long_wait_until(collect_pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + i); \
             }                                                           \
+                                                                        \
+            shmem_long_p(collect_pSync, SHCOLL_SYNC_VALUE, me);         \
         }                                                               \
                                                                         \
         /* Check if the current PE should wait/send data to the peer */ \
@@ -464,27 +1334,677 @@
             shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE + 1, peer);       \
         }                                                               \
                                                                         \
-        if (tmp_array != NULL) {                                        \
+        free(tmp_array);                                                \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, rabenseifner2)
+
+/*
+ * Rabenseifner implementation with reduced precision wire format
+ *
+ * Partial results are exchanged in the narrower _wire_type through pWrk and
+ * accumulated in _type locally.  pWrk is big enough to hold the whole vector
+ * in the wire format as long as the wire type is at most half as wide as
+ * _type.  All the blocks, including the one reduced locally, are converted
+ * once more for the allgather, so all the PEs end up with the same result.
+ * The allgather is done with recursive doubling, as in rabenseifner, or on a
+ * ring, as in rabenseifner2.
+ *
+ * The received blocks are converted REDUCE_WIRE_CHUNK elements at a time into
+ * a _type buffer and accumulated from there, so that both loops are simple
+ * enough to be vectorized.
+ */
+
+#define REDUCE_WIRE_CHUNK 256
+
+#define REDUCE_HELPER_RABENSEIFNER_WIRE(_name, _type, _wire, _wire_type, \
+                                        _to_wire, _from_wire)           \
+    inline static void                                                  \
+    _name##_to_##_wire(_wire_type *dest, const _type *src, size_t nelems) \
+    {                                                                   \
+        size_t i;                                                       \
+                                                                        \
+        for (i = 0; i < nelems; i++) {                                  \
+            dest[i] = _to_wire(src[i]);                                 \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    inline static void                                                  \
+    _name##_from_##_wire(_type *dest, const _wire_type *src, size_t nelems) \
+    {                                                                   \
+        size_t i;                                                       \
+                                                                        \
+        for (i = 0; i < nelems; i++) {                                  \
+            dest[i] = (_type) _from_wire(src[i]);                       \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    inline static void                                                  \
+    _name##_accumulate_##_wire(_type *acc, const _wire_type *src,       \
+                               size_t nelems)                           \
+    {                                                                   \
+        _type chunk[REDUCE_WIRE_CHUNK];                                 \
+        size_t chunk_nelems;                                            \
+        size_t i;                                                       \
+        size_t j;                                                       \
+                                                                        \
+        for (i = 0; i < nelems; i += chunk_nelems) {                    \
+            chunk_nelems = nelems - i < REDUCE_WIRE_CHUNK ? nelems - i : REDUCE_WIRE_CHUNK; \
+                                                                        \
+            _name##_from_##_wire(chunk, src + i, chunk_nelems);         \
+            for (j = 0; j < chunk_nelems; j++) {                        \
+                acc[i + j] += chunk[j];                                 \
+            }                                                           \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    inline static void                                                  \
+    _name##_helper_rabenseifner_##_wire(_type *dest, const _type *source, \
+                                        size_t nreduce, int PE_start,   \
+                                        int logPE_stride, int PE_size,  \
+                                        _type *pWrk, long *pSync, int ring) \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+        const size_t nelems = nreduce;                                  \
+                                                                        \
+        /* pSync[0] notifies the fold peer, pSync[1] counts its acks,   \
+         * pSync[2 + round] is used by both reduce scatter and          \
+         * allgather, pSync[2 + PE_SIZE_LOG] counts the peers that have \
+         * read my blocks, pSync[3 + PE_SIZE_LOG] counts the blocks     \
+         * received on the ring and pSync[4 + PE_SIZE_LOG] is set when  \
+         * the ring peer can receive them */                            \
+        long *fold_pSync = pSync;                                       \
+        long *fold_ack_pSync = pSync + 1;                               \
+        long *round_pSync = pSync + 2;                                  \
+        long *ack_pSync = pSync + 2 + PE_SIZE_LOG;                      \
+        long *ring_pSync = pSync + 3 + PE_SIZE_LOG;                     \
+        long *ready_pSync = pSync + 4 + PE_SIZE_LOG;                    \
+                                                                        \
+        _wire_type *wire = (_wire_type *) pWrk;                         \
+        _wire_type *tmp_wire = NULL;                                    \
+        _type *acc = NULL;                                              \
+                                                                        \
+        int block_idx_begin;                                            \
+        int block_idx_end;                                              \
+        int block_idx_half;                                             \
+        size_t block_offset;                                            \
+        size_t next_block_offset;                                       \
+                                                                        \
+        int xchg_peer_p2s;                                              \
+        int xchg_peer_pe;                                               \
+        int ring_peer_pe;                                               \
+        int peer_pe;                                                    \
+                                                                        \
+        /* Power 2 set */                                               \
+        int me_p2s;                                                     \
+        int p2s_size;                                                   \
+        int log_p2s_size;                                               \
+                                                                        \
+        int distance;                                                   \
+        int round;                                                      \
+                                                                        \
+        /* Find the greatest power of 2 lower than PE_size */           \
+        for (p2s_size = 1, log_p2s_size = 0; p2s_size * 2 <= PE_size; p2s_size *= 2, log_p2s_size++); \
+                                                                        \
+        /* Check if the current PE belongs to the power 2 set */        \
+        me_p2s = me_as * p2s_size / PE_size;                            \
+        if ((me_p2s * PE_size + p2s_size - 1) / p2s_size != me_as) {    \
+            me_p2s = -1;                                                \
+        }                                                               \
+                                                                        \
+        if (me_p2s == -1) {                                             \
+            /* Hand over the whole vector to the peer and wait for the result */ \
+            peer_pe = PE_start + (me_as - 1) * stride;                  \
+                                                                        \
+            _name##_to_##_wire(wire, source, nelems);                   \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE + 1, peer_pe);   \
+                                                                        \
+            shmem_long_wait_until(fold_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);            \
+                                                                        \
+            tmp_wire = malloc(nelems * sizeof(_wire_type));             \
+            if (tmp_wire == NULL) {                                     \
+                /* TODO: raise error */                                 \
+                fprintf(stderr, "PE %d: Cannot allocate memory!\n", me); \
+                exit(-1);                                               \
+            }                                                           \
+                                                                        \
+            shmem_getmem(tmp_wire, wire, nelems * sizeof(_wire_type), peer_pe); \
+            shmem_long_atomic_inc(fold_ack_pSync, peer_pe);             \
+                                                                        \
+            _name##_from_##_wire(dest, tmp_wire, nelems);               \
+                                                                        \
+            free(tmp_wire);                                             \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        acc = malloc(nelems * sizeof(_type));                           \
+        tmp_wire = malloc((nelems / 2 + 1) * sizeof(_wire_type));       \
+        if (acc == NULL || tmp_wire == NULL) {                          \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
+        }                                                               \
+                                                                        \
+        memcpy(acc, source, nelems * sizeof(_type));                    \
+                                                                        \
+        /* Fold the vector of the PE outside the power 2 set */         \
+        if ((me_as + 1) * p2s_size / PE_size == me_p2s) {               \
+            peer_pe = PE_start + (me_as + 1) * stride;                  \
+                                                                        \
+            shmem_long_wait_until(fold_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);            \
+                                                                        \
+            /* The whole vector does not fit into tmp_wire, so get it in halves */ \
+            for (block_offset = 0; block_offset < nelems; block_offset = next_block_offset) { \
+                next_block_offset = block_offset + nelems / 2 + 1 < nelems ? \
+                                    block_offset + nelems / 2 + 1 : nelems; \
+                shmem_getmem(tmp_wire, wire + block_offset,             \
+                             (next_block_offset - block_offset) * sizeof(_wire_type), peer_pe); \
+                _name##_accumulate_##_wire(acc + block_offset, tmp_wire, \
+                                           next_block_offset - block_offset); \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        /* Reduce scatter: only the halves that are handed over are converted */ \
+        block_idx_begin = 0;                                            \
+        block_idx_end = p2s_size;                                       \
+                                                                        \
+        for (distance = 1, round = 0; distance < p2s_size; distance <<= 1, round++) { \
+            xchg_peer_p2s = ((me_p2s & distance) == 0) ? me_p2s + distance : me_p2s - distance; \
+            xchg_peer_pe = PE_start + stride * ((xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size); \
+                                                                        \
+            block_idx_half = (block_idx_begin + block_idx_end) / 2;     \
+                                                                        \
+            /* Publish the half the peer is responsible for */          \
+            if ((me_p2s & distance) == 0) {                             \
+                block_offset = reduce_block_offset(block_idx_half, nelems, p2s_size); \
+                next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
+                block_idx_end = block_idx_half;                         \
+            } else {                                                    \
+                block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+                next_block_offset = reduce_block_offset(block_idx_half, nelems, p2s_size); \
+                block_idx_begin = block_idx_half;                       \
+            }                                                           \
+                                                                        \
+            _name##_to_##_wire(wire + block_offset, acc + block_offset, \
+                               next_block_offset - block_offset);       \
+            shmem_long_atomic_inc(round_pSync + round, xchg_peer_pe);   \
+                                                                        \
+            /* Get the peer's part of my half and accumulate */         \
+            block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+            next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
+                                                                        \
+            shmem_long_wait_until(round_pSync + round, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1); \
+            shmem_getmem(tmp_wire, wire + block_offset,                 \
+                         (next_block_offset - block_offset) * sizeof(_wire_type), \
+                         xchg_peer_pe);                                 \
+                                                                        \
+            /* The ring puts blocks into wire, so the peer must know when \
+             * its half has been read */                                \
+            if (ring) {                                                 \
+                shmem_long_p(round_pSync + round, SHCOLL_SYNC_VALUE, me); \
+                shmem_long_atomic_inc(ack_pSync, xchg_peer_pe);         \
+            }                                                           \
+                                                                        \
+            _name##_accumulate_##_wire(acc + block_offset, tmp_wire,    \
+                                       next_block_offset - block_offset); \
+        }                                                               \
+                                                                        \
+        /* Publish the reduced block */                                 \
+        block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+        next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
+        _name##_to_##_wire(wire + block_offset, acc + block_offset,     \
+                           next_block_offset - block_offset);           \
+                                                                        \
+        if (ring) {                                                     \
+            /* Allgather in wire format on the ring of the power 2 set */ \
+            ring_peer_pe = PE_start + stride * ((((me_p2s + 1) % p2s_size) * PE_size + p2s_size - 1) / p2s_size); \
+            peer_pe = PE_start + stride * ((((me_p2s - 1 + p2s_size) % p2s_size) * PE_size + p2s_size - 1) / p2s_size); \
+                                                                        \
+            /* The left PE may put into wire once my halves are read */ \
+            shmem_long_wait_until(ack_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + log_p2s_size); \
+            shmem_long_p(ack_pSync, SHCOLL_SYNC_VALUE, me);             \
+            shmem_long_p(ready_pSync, SHCOLL_SYNC_VALUE + 1, peer_pe);  \
+                                                                        \
+            shmem_long_wait_until(ready_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            shmem_long_p(ready_pSync, SHCOLL_SYNC_VALUE, me);           \
+                                                                        \
+            for (round = 0; round < p2s_size - 1; round++) {            \
+                block_idx_begin = reverse_bits((me_p2s - round + p2s_size) % p2s_size, log_p2s_size); \
+                block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+                next_block_offset = reduce_block_offset(block_idx_begin + 1, nelems, p2s_size); \
+                                                                        \
+                shmem_putmem_nbi(wire + block_offset, wire + block_offset, \
+                                 (next_block_offset - block_offset) * sizeof(_wire_type), \
+                                 ring_peer_pe);                         \
+                shmem_fence();                                          \
+                shmem_long_p(ring_pSync, SHCOLL_SYNC_VALUE + round + 1, ring_peer_pe); \
+                                                                        \
+                shmem_long_wait_until(ring_pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + round); \
+            }                                                           \
+                                                                        \
+            shmem_long_p(ring_pSync, SHCOLL_SYNC_VALUE, me);            \
+        } else {                                                        \
+            /* Allgather in wire format, in the reverse order of rounds */ \
+            for (distance = p2s_size / 2, round = log_p2s_size - 1; distance > 0; distance >>= 1, round--) { \
+                xchg_peer_p2s = ((me_p2s & distance) == 0) ? me_p2s + distance : me_p2s - distance; \
+                xchg_peer_pe = PE_start + stride * ((xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size); \
+                                                                        \
+                shmem_long_atomic_inc(round_pSync + round, xchg_peer_pe); \
+                shmem_long_wait_until(round_pSync + round, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 2); \
+                shmem_long_p(round_pSync + round, SHCOLL_SYNC_VALUE, me); \
+                                                                        \
+                if ((me_p2s & distance) == 0) {                         \
+                    block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
+                    block_idx_end += block_idx_end - block_idx_begin;   \
+                    next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
+                } else {                                                \
+                    next_block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+                    block_idx_begin -= block_idx_end - block_idx_begin; \
+                    block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+                }                                                       \
+                                                                        \
+                shmem_getmem(wire + block_offset, wire + block_offset,  \
+                             (next_block_offset - block_offset) * sizeof(_wire_type), \
+                             xchg_peer_pe);                             \
+                shmem_long_atomic_inc(ack_pSync, xchg_peer_pe);         \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        _name##_from_##_wire(dest, wire, nelems);                       \
+                                                                        \
+        /* Let the PE outside the power 2 set read the result */        \
+        if ((me_as + 1) * p2s_size / PE_size == me_p2s) {               \
+            peer_pe = PE_start + (me_as + 1) * stride;                  \
+                                                                        \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE + 1, peer_pe);   \
+            shmem_long_wait_until(fold_ack_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            shmem_long_p(fold_ack_pSync, SHCOLL_SYNC_VALUE, me);        \
+        }                                                               \
+                                                                        \
+        /* Wait until the peers have read my blocks */                  \
+        if (!ring) {                                                    \
+            shmem_long_wait_until(ack_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + log_p2s_size); \
+            shmem_long_p(ack_pSync, SHCOLL_SYNC_VALUE, me);             \
+        }                                                               \
+                                                                        \
+        free(acc);                                                      \
+        free(tmp_wire);                                                 \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_to_all_rabenseifner_##_wire##_size(_type *dest,    \
+                                                        const _type *source, \
+                                                        size_t nreduce, \
+                                                        int PE_start,   \
+                                                        int logPE_stride, \
+                                                        int PE_size,    \
+                                                        _type *pWrk,    \
+                                                        long *pSync)    \
+    {                                                                   \
+        _name##_helper_rabenseifner_##_wire(dest, source, nreduce, PE_start, \
+                                            logPE_stride, PE_size,      \
+                                            pWrk, pSync, 0);            \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_to_all_rabenseifner2_##_wire##_size(_type *dest,   \
+                                                         const _type *source, \
+                                                         size_t nreduce, \
+                                                         int PE_start,  \
+                                                         int logPE_stride, \
+                                                         int PE_size,   \
+                                                         _type *pWrk,   \
+                                                         long *pSync)   \
+    {                                                                   \
+        _name##_helper_rabenseifner_##_wire(dest, source, nreduce, PE_start, \
+                                            logPE_stride, PE_size,      \
+                                            pWrk, pSync, 1);            \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, rabenseifner_##_wire)                \
+    REDUCE_INT_COUNT(_name, _type, rabenseifner2_##_wire)
+
+#define DOUBLE_TO_FP32(_x)  ((float) (_x))
+#define FP32_TO_DOUBLE(_x)  ((double) (_x))
+#define DOUBLE_TO_FP16(_x)  float_to_fp16((float) (_x))
+#define DOUBLE_TO_BF16(_x)  float_to_bf16((float) (_x))
+
+/*
+ * Knomial tree reduction to root implementation
+ */
+
+#define REDUCE_HELPER_ROOTED_KNOMIAL(_name, _type, _op)                 \
+    inline static void                                                  \
+    reduce_##_name##_helper_knomial(_type *dest, const _type *source,   \
+                                    size_t nreduce, int PE_root,        \
+                                    int PE_start, int logPE_stride,     \
+                                    int PE_size, int tree_radix,        \
+                                    long *pSync)                        \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+        const size_t nbytes = sizeof(_type) * nreduce;                  \
+                                                                        \
+        /* pSync[0] is used to receive the ack from the parent          \
+         * pSync[1..1+groups_num) count the children ready in each group */ \
+        long *ack_pSync = pSync;                                        \
+        long *groups_pSync = pSync + 1;                                 \
+                                                                        \
+        node_info_knomial_t node;                                       \
+        _type *tmp_array = NULL;                                        \
+        int child_offset;                                               \
+        int child_pe;                                                   \
+        int group;                                                      \
+        int i;                                                          \
+                                                                        \
+        get_node_info_knomial_root(PE_size, PE_root, tree_radix, me_as, &node); \
+                                                                        \
+        if (source != dest) {                                           \
+            memcpy(dest, source, nbytes);                               \
+        }                                                               \
+                                                                        \
+        if (node.children_num != 0) {                                   \
+            tmp_array = malloc(nbytes);                                 \
+            if (tmp_array == NULL) {                                    \
+                /* TODO: raise error */                                 \
+                fprintf(stderr, "PE %d: Cannot allocate memory!\n", me); \
+                exit(-1);                                               \
+            }                                                           \
+                                                                        \
+            /* The last group has the smallest subtrees, so it is ready first */ \
+            child_offset = node.children_num;                           \
+            for (group = node.groups_num - 1; group >= 0; group--) {    \
+                child_offset -= node.groups_sizes[group];               \
+                                                                        \
+                shmem_long_wait_until(groups_pSync + group, SHMEM_CMP_EQ, \
+                                      SHCOLL_SYNC_VALUE + node.groups_sizes[group]); \
+                shmem_long_p(groups_pSync + group, SHCOLL_SYNC_VALUE, me); \
+                                                                        \
+                for (i = 0; i < node.groups_sizes[group]; i++) {        \
+                    child_pe = PE_start + node.children[child_offset + i] * stride; \
+                                                                        \
+                    /* Get partial result and let the child leave */    \
+                    shmem_getmem(tmp_array, dest, nbytes, child_pe);    \
+                    shmem_long_p(ack_pSync, SHCOLL_SYNC_VALUE + 1, child_pe); \
+                                                                        \
+                    local_##_name##_reduce(dest, dest, tmp_array, nreduce); \
+                }                                                       \
+            }                                                           \
+                                                                        \
             free(tmp_array);                                            \
+        }                                                               \
+                                                                        \
+        if (node.parent != -1) {                                        \
+            /* Notify parent that the partial result is ready */        \
+            group = knomial_tree_parent_group(PE_size, PE_root, tree_radix, \
+                                              me_as, node.parent);      \
+            shmem_long_atomic_inc(groups_pSync + group,                 \
+                                  PE_start + node.parent * stride);     \
+                                                                        \
+            /* Wait until the parent has read the partial result */     \
+            shmem_long_wait_until(ack_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            shmem_long_p(ack_pSync, SHCOLL_SYNC_VALUE, me);             \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_reduce_binomial(_type *dest, const _type *source,  \
+                                     int nreduce, int PE_root,          \
+                                     int PE_start, int logPE_stride,    \
+                                     int PE_size,                       \
+                                     _type *pWrk, long *pSync)          \
+    {                                                                   \
+        reduce_##_name##_helper_knomial(dest, source, nreduce, PE_root, \
+                                        PE_start, logPE_stride, PE_size, \
+                                        2, pSync);                      \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_reduce_knomial(_type *dest, const _type *source,   \
+                                    int nreduce, int PE_root,           \
+                                    int PE_start, int logPE_stride,     \
+                                    int PE_size,                        \
+                                    _type *pWrk, long *pSync)           \
+    {                                                                   \
+        reduce_##_name##_helper_knomial(dest, source, nreduce, PE_root, \
+                                        PE_start, logPE_stride, PE_size, \
+                                        knomial_tree_radix_reduce, pSync); \
+    }
+
+/*
+ * Knomial tree reduction implementation (reduce to root + broadcast)
+ */
+
+#define REDUCE_HELPER_KNOMIAL(_name, _type, _op)                        \
+    void                                                                \
+    shcoll_##_name##_to_all_knomial_size(_type *dest, const _type *source, \
+                                         size_t nreduce, int PE_start,  \
+                                         int logPE_stride, int PE_size, \
+                                         _type *pWrk, long *pSync)      \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+        const size_t nbytes = sizeof(_type) * nreduce;                  \
+                                                                        \
+        /* pSync[0..1 + PE_SIZE_LOG) are used by the reduction */       \
+        long *bcast_pSync = pSync + 1 + PE_SIZE_LOG;                    \
+                                                                        \
+        node_info_knomial_t node;                                       \
+        int child_pe;                                                   \
+        int i;                                                          \
+                                                                        \
+        reduce_##_name##_helper_knomial(dest, source, nreduce, 0,       \
+                                        PE_start, logPE_stride, PE_size, \
+                                        knomial_tree_radix_reduce, pSync); \
+                                                                        \
+        /* Broadcast the result down the same tree */                   \
+        get_node_info_knomial_root(PE_size, 0, knomial_tree_radix_reduce, \
+                                   me_as, &node);                       \
+                                                                        \
+        if (node.parent != -1) {                                        \
+            shmem_long_wait_until(bcast_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            shmem_long_p(bcast_pSync, SHCOLL_SYNC_VALUE, me);           \
+        }                                                               \
+                                                                        \
+        for (i = 0; i < node.children_num; i++) {                       \
+            child_pe = PE_start + node.children[i] * stride;            \
+            shmem_putmem(dest, dest, nbytes, child_pe);                 \
+        }                                                               \
+                                                                        \
+        shmem_fence();                                                  \
+                                                                        \
+        for (i = 0; i < node.children_num; i++) {                       \
+            child_pe = PE_start + node.children[i] * stride;            \
+            shmem_long_p(bcast_pSync, SHCOLL_SYNC_VALUE + 1, child_pe); \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, knomial)
+
+/*
+ * Atomic-based implementation for tiny integer reductions
+ *
+ * Every PE applies its contribution with remote atomics to accumulators in
+ * the pSync of the first PE of the active set, and the result is pushed back
+ * down the knomial tree.  The accumulators are reset to SHCOLL_SYNC_VALUE
+ * (0) after each call, so every value is encoded such that 0 is the identity
+ * of the operation: AND is computed as the complement of the OR of
+ * complements, MAX and MIN use an order-preserving (resp. reversing) map to
+ * unsigned long with a compare-and-swap loop.
+ */
+
+#define REDUCE_ATOMIC_MAX_NREDUCE 4
+
+#define REDUCE_ATOMIC_SIGN_BIT (1UL << (sizeof(long) * CHAR_BIT - 1))
+
+inline static void
+reduce_atomic_ulong_max(long *acc, unsigned long value, int pe)
+{
+    unsigned long old = (unsigned long) shmem_long_atomic_fetch(acc, pe);
+    unsigned long prev;
+
+    while (value > old) {
+        prev = (unsigned long) shmem_long_atomic_compare_swap(acc, (long) old, (long) value, pe);
+        if (prev == old) {
+            break;
+        }
+
+        old = prev;
+    }
+}
+
+#define ATOMIC_SUM_ENCODE(_x)           ((long) (_x))
+#define ATOMIC_SUM_DECODE(_v)           (_v)
+#define ATOMIC_SUM_APPLY(_acc, _v, _pe) shmem_long_atomic_add(_acc, _v, _pe)
+
+#define ATOMIC_AND_ENCODE(_x)           (~(long) (_x))
+#define ATOMIC_AND_DECODE(_v)           (~(_v))
+#define ATOMIC_AND_APPLY(_acc, _v, _pe) \
+    shmem_ulong_atomic_or((unsigned long *) (_acc), (unsigned long) (_v), _pe)
+
+#define ATOMIC_OR_ENCODE(_x)            ((long) (_x))
+#define ATOMIC_OR_DECODE(_v)            (_v)
+#define ATOMIC_OR_APPLY(_acc, _v, _pe)  \
+    shmem_ulong_atomic_or((unsigned long *) (_acc), (unsigned long) (_v), _pe)
+
+#define ATOMIC_XOR_ENCODE(_x)           ((long) (_x))
+#define ATOMIC_XOR_DECODE(_v)           (_v)
+#define ATOMIC_XOR_APPLY(_acc, _v, _pe) \
+    shmem_ulong_atomic_xor((unsigned long *) (_acc), (unsigned long) (_v), _pe)
+
+#define ATOMIC_MAX_ENCODE(_x)           ((long) ((unsigned long) (long) (_x) ^ REDUCE_ATOMIC_SIGN_BIT))
+#define ATOMIC_MAX_DECODE(_v)           ((long) ((unsigned long) (_v) ^ REDUCE_ATOMIC_SIGN_BIT))
+#define ATOMIC_MAX_APPLY(_acc, _v, _pe) reduce_atomic_ulong_max(_acc, (unsigned long) (_v), _pe)
+
+#define ATOMIC_MIN_ENCODE(_x)           (~ATOMIC_MAX_ENCODE(_x))
+#define ATOMIC_MIN_DECODE(_v)           ATOMIC_MAX_DECODE(~(_v))
+#define ATOMIC_MIN_APPLY(_acc, _v, _pe) reduce_atomic_ulong_max(_acc, (unsigned long) (_v), _pe)
+
+#define REDUCE_HELPER_ATOMIC(_name, _type, _kind)                       \
+    void                                                                \
+    shcoll_##_name##_to_all_atomic(_type *dest, const _type *source,    \
+                                   int nreduce, int PE_start,           \
+                                   int logPE_stride, int PE_size,       \
+                                   _type *pWrk, long *pSync)            \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+                                                                        \
+        /* pSync[0..REDUCE_ATOMIC_MAX_NREDUCE) are the accumulators on  \
+         * the root and receive the result on the other PEs, the next   \
+         * word counts arrivals on the root and flags the result on the \
+         * other PEs */                                                 \
+        long *acc_pSync = pSync;                                        \
+        long *flag_pSync = pSync + REDUCE_ATOMIC_MAX_NREDUCE;           \
+                                                                        \
+        long result[REDUCE_ATOMIC_MAX_NREDUCE];                         \
+        node_info_knomial_t node;                                       \
+        int child_pe;                                                   \
+        int i;                                                          \
+                                                                        \
+        if (nreduce > REDUCE_ATOMIC_MAX_NREDUCE) {                      \
+            shcoll_##_name##_to_all_rec_dbl(dest, source, nreduce,      \
+                                            PE_start, logPE_stride,     \
+                                            PE_size, pWrk, pSync);      \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        for (i = 0; i < nreduce; i++) {                                 \
+            ATOMIC_##_kind##_APPLY(acc_pSync + i,                       \
+                                   ATOMIC_##_kind##_ENCODE(source[i]),  \
+                                   PE_start);                           \
+        }                                                               \
+                                                                        \
+        shmem_fence();                                                  \
+        shmem_long_atomic_inc(flag_pSync, PE_start);                    \
+                                                                        \
+        if (me_as == 0) {                                               \
+            shmem_long_wait_until(flag_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + PE_size); \
+        } else {                                                        \
+            shmem_long_wait_until(flag_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+        }                                                               \
+                                                                        \
+        for (i = 0; i < nreduce; i++) {                                 \
+            result[i] = acc_pSync[i];                                   \
+            shmem_long_p(acc_pSync + i, SHCOLL_SYNC_VALUE, me);         \
+        }                                                               \
+                                                                        \
+        shmem_long_p(flag_pSync, SHCOLL_SYNC_VALUE, me);                \
+                                                                        \
+        /* Push the result down the tree */                             \
+        get_node_info_knomial_root(PE_size, 0, knomial_tree_radix_reduce, \
+                                   me_as, &node);                       \
+                                                                        \
+        for (i = 0; i < node.children_num; i++) {                       \
+            child_pe = PE_start + node.children[i] * stride;            \
+            shmem_long_put(acc_pSync, result, nreduce, child_pe);       \
+        }                                                               \
+                                                                        \
+        shmem_fence();                                                  \
+                                                                        \
+        for (i = 0; i < node.children_num; i++) {                       \
+            child_pe = PE_start + node.children[i] * stride;            \
+            shmem_long_p(flag_pSync, SHCOLL_SYNC_VALUE + 1, child_pe);  \
+        }                                                               \
+                                                                        \
+        for (i = 0; i < nreduce; i++) {                                 \
+            dest[i] = (_type) ATOMIC_##_kind##_DECODE(result[i]);       \
         }                                                               \
     }
 
+#define SHCOLL_REDUCE_ATOMIC_DEFINE(_name)                      \
+    _name(short_and,        short,      AND)                    \
+        _name(int_and,          int,        AND)                \
+        _name(long_and,         long,       AND)                \
+                                                                \
+        _name(short_max,        short,      MAX)                \
+        _name(int_max,          int,        MAX)                \
+        _name(long_max,         long,       MAX)                \
+                                                                \
+        _name(short_min,        short,      MIN)                \
+        _name(int_min,          int,        MIN)                \
+        _name(long_min,         long,       MIN)                \
+                                                                \
+        _name(short_sum,        short,      SUM)                \
+        _name(int_sum,          int,        SUM)                \
+        _name(long_sum,         long,       SUM)                \
+                                                                \
+        _name(short_or,         short,      OR)                 \
+        _name(int_or,           int,        OR)                 \
+        _name(long_or,          long,       OR)                 \
+                                                                \
+        _name(short_xor,        short,      XOR)                \
+        _name(int_xor,          int,        XOR)                \
+        _name(long_xor,         long,       XOR)
 
-#define REDUCE_HELPER_RABENSEIFNER2(_name, _type, _op)                  \
+/*
+ * Rabenseifner reduction to root implementation (reduce scatter + gather)
+ */
+
+#define REDUCE_HELPER_ROOTED_RABENSEIFNER(_name, _type, _op)            \
     void                                                                \
-    shcoll_##_name##_to_all_rabenseifner2(_type *dest, const _type *source, \
-                                          int nreduce, int PE_start,    \
-                                          int logPE_stride, int PE_size, \
-                                          _type *pWrk, long *pSync)     \
+    shcoll_##_name##_reduce_rabenseifner(_type *dest, const _type *source, \
+                                         int nreduce, int PE_root,      \
+                                         int PE_start, int logPE_stride, \
+                                         int PE_size,                   \
+                                         _type *pWrk, long *pSync)      \
     {                                                                   \
         const int stride = 1 << logPE_stride;                           \
         const int me = shmem_my_pe();                                   \
+        const int root_pe = PE_start + PE_root * stride;                \
                                                                         \
         int me_as = (me - PE_start) / stride;                           \
         int peer;                                                       \
         size_t i;                                                       \
-                                                                        \
         const size_t nelems = (const size_t) nreduce;                   \
+                                                                        \
         int block_idx_begin;                                            \
         int block_idx_end;                                              \
                                                                         \
@@ -496,10 +2016,6 @@
         int xchg_peer_as;                                               \
         int xchg_peer_pe;                                               \
                                                                         \
-        int ring_peer_p2s;                                              \
-        int ring_peer_as;                                               \
-        int ring_peer_pe;                                               \
-                                                                        \
         /* Power 2 set */                                               \
         int me_p2s;                                                     \
         int p2s_size;                                                   \
@@ -508,7 +2024,7 @@
         int distance;                                                   \
         _type *tmp_array = NULL;                                        \
                                                                         \
-        long *collect_pSync = pSync + (1 + sizeof(int) * CHAR_BIT);     \
+        long *gather_pSync = pSync + (1 + sizeof(int) * CHAR_BIT);      \
                                                                         \
         /* Find the greatest power of 2 lower than PE_size */           \
         for (p2s_size = 1, log_p2s_size = 0; p2s_size * 2 <= PE_size; p2s_size *= 2, log_p2s_size++); \
@@ -519,14 +2035,13 @@
             me_p2s = -1;                                                \
         }                                                               \
                                                                         \
-        /* If current PE belongs to the power 2 set, it will need temporary buffer */ \
-        if (me_p2s != -1) {                                             \
-            tmp_array = malloc((nelems / 2 + 1) * sizeof(_type));       \
-            if (tmp_array == NULL) {                                    \
-                /* TODO: raise error */                                 \
-                fprintf(stderr, "PE %d: Cannot allocate memory!\n", me); \
-                exit(-1);                                               \
-            }                                                           \
+        /* The data of the peers is received in the temporary buffer, so that \
+         * dest is never written before source has been read */         \
+        tmp_array = malloc((nelems / 2 + 1) * sizeof(_type));           \
+        if (tmp_array == NULL) {                                        \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
         }                                                               \
                                                                         \
         /* Check if the current PE should wait/send data to the peer */ \
@@ -540,10 +2055,11 @@
             block_nelems = (size_t) (nelems - block_offset);            \
                                                                         \
             shmem_long_wait_until(pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
-            shmem_getmem(dest + block_offset, source + block_offset, block_nelems * sizeof(_type), peer); \
+            shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);                 \
+            shmem_getmem(tmp_array, source + block_offset, block_nelems * sizeof(_type), peer); \
                                                                         \
             /* Reduce the upper half of the array */                    \
-            local_##_name##_reduce(dest + block_offset, dest + block_offset, source + block_offset, block_nelems); \
+            local_##_name##_reduce(dest + block_offset, source + block_offset, tmp_array, block_nelems); \
                                                                         \
             /* Send the upper half of the array to peer */              \
             shmem_putmem(dest + block_offset, dest + block_offset, block_nelems * sizeof(_type), peer); \
@@ -559,15 +2075,15 @@
             block_nelems = (size_t) (nelems / 2 - block_offset);        \
                                                                         \
             shmem_long_wait_until(pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE); \
-            shmem_getmem(dest, source, block_nelems * sizeof(_type), peer); \
+            shmem_getmem(tmp_array, source, block_nelems * sizeof(_type), peer); \
                                                                         \
             /* Do local reduce */                                       \
-            local_##_name##_reduce(dest, dest, source, block_nelems);   \
+            local_##_name##_reduce(dest, source, tmp_array, block_nelems); \
                                                                         \
             /* Wait until the upper half is received from peer */       \
             shmem_long_wait_until(pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + 1); \
             shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);                 \
-        } else {                                                        \
+        } else if (dest != source) {                                    \
             memcpy(dest, source, nelems * sizeof(_type));               \
         }                                                               \
                                                                         \
@@ -593,9 +2109,8 @@
                     block_idx_begin = (block_idx_begin + block_idx_end) / 2; \
                 }                                                       \
                                                                         \
-                /* TODO: possible overflow */                           \
-                block_offset = (block_idx_begin * nelems) / p2s_size;   \
-                next_block_offset = (block_idx_end * nelems) / p2s_size; \
+                block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+                next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
                 block_nelems = (size_t) (next_block_offset - block_offset); \
                                                                         \
                 /* Wait until the data on peer PE is ready to be read and get the data */ \
@@ -617,124 +2132,753 @@
                                                                         \
         /* For nodes in the power 2 set, destination will contain the reduced block */ \
                                                                         \
-        /* Do collect with the nodes in power 2 set */                  \
-        if (me_p2s != -1) {                                             \
-            ring_peer_p2s = (me_p2s + 1) % p2s_size;                    \
-            ring_peer_as = (ring_peer_p2s * PE_size + p2s_size - 1) / p2s_size; \
-            ring_peer_pe = PE_start + ring_peer_as * stride;            \
+        /* Gather the reduced blocks on the root */                     \
+        if (me_p2s != -1 && me != root_pe) {                            \
+            block_idx_begin = reverse_bits(me_p2s, log_p2s_size);       \
+            block_idx_end = block_idx_begin + 1;                        \
                                                                         \
-            for (i = 0; i < p2s_size; i++) {                            \
-                block_idx_begin = reverse_bits((int) ((me_p2s - i + p2s_size) % p2s_size), log_p2s_size); \
-                block_idx_end = block_idx_begin + 1;                    \
+            block_offset = reduce_block_offset(block_idx_begin, nelems, p2s_size); \
+            next_block_offset = reduce_block_offset(block_idx_end, nelems, p2s_size); \
+            block_nelems = (size_t) (next_block_offset - block_offset); \
                                                                         \
-                /* TODO: possible overflow */                           \
-                block_offset = (block_idx_begin * nelems) / p2s_size;   \
-                next_block_offset = (block_idx_end * nelems) / p2s_size; \
-                block_nelems = (size_t) (next_block_offset - block_offset); \
+            shmem_putmem(dest + block_offset, dest + block_offset,      \
+                         block_nelems * sizeof(_type), root_pe);        \
+            shmem_fence();                                              \
+            shmem_long_atomic_inc(gather_pSync, root_pe);               \
+        }                                                               \
                                                                         \
-                shmem_putmem_nbi(dest + block_offset, dest + block_offset, \
-                                 block_nelems * sizeof(_type), ring_peer_pe); \
-                shmem_fence();                                          \
-                shmem_long_p(collect_pSync, SHCOLL_SYNC_VALUE + i + 1, ring_peer_pe); \
+        if (me == root_pe) {                                            \
+            shmem_long_wait_until(gather_pSync, SHMEM_CMP_EQ,           \
+                                  SHCOLL_SYNC_VALUE + p2s_size - (me_p2s != -1 ? 1 : 0)); \
+            shmem_long_p(gather_pSync, SHCOLL_SYNC_VALUE, me);          \
+        }                                                               \
                                                                         \
-                shmem_long_wait_until(collect_pSync, SHMEM_CMP_GT, SHCOLL_SYNC_VALUE + i); \
+        free(tmp_array);                                                \
+    }
+
+
+/*
+ * Hierarchical (node-aware) implementation
+ *
+ * The local PEs of a node reduce disjoint blocks of the vector straight from
+ * each other's source with shmem_ptr, into pWrk of the node leader (the
+ * first local PE), so pWrk must hold nreduce elements.  The leaders reduce
+ * between the nodes with rec_dbl or Rabenseifner, depending on the size,
+ * and the local PEs copy the result from the leader.  If some PEs cannot reach
+ * their whole node, every PE is a node of its own and the reduction is flat.
+ */
+
+#define REDUCE_HELPER_HIERARCHICAL(_name, _type, _op)                   \
+    void                                                                \
+    shcoll_##_name##_to_all_hierarchical_size(_type *dest, const _type *source, \
+                                              size_t nreduce, int PE_start, \
+                                              int logPE_stride, int PE_size, \
+                                              _type *pWrk, long *pSync) \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+        const size_t nelems = (size_t) nreduce;                         \
+        const size_t nbytes = nelems * sizeof(_type);                   \
+                                                                        \
+        /* pSync[0 .. 2] count the local PEs on the leader, pSync[3] releases \
+         * the other local PEs, pSync[4 .. SHCOLL_REDUCE_SYNC_SIZE) is used \
+         * between the leaders and the last 2 * PE_SIZE_LOG elements to \
+         * get the node size */                                         \
+        long *arrive_pSync = pSync;                                     \
+        long *done_pSync = pSync + 1;                                   \
+        long *copied_pSync = pSync + 2;                                 \
+        long *local_pSync = pSync + 3;                                  \
+        long *inter_pSync = pSync + 4;                                  \
+        long *node_pSync = pSync + SHCOLL_REDUCE_SYNC_SIZE;             \
+                                                                        \
+        int node_size;                                                  \
+        int nnodes;                                                     \
+        int local_rank;                                                 \
+        int local_size;                                                 \
+        int leader_pe;                                                  \
+        int i;                                                          \
+                                                                        \
+        size_t block_offset;                                            \
+        size_t next_block_offset;                                       \
+                                                                        \
+        _type *node_array;                                              \
+        const _type *local_source;                                      \
+                                                                        \
+        node_size = reduce_get_node_size(dest, source, pWrk, PE_start, logPE_stride, \
+                                         PE_size, node_pSync);          \
+        nnodes = (PE_size + node_size - 1) / node_size;                 \
+        local_rank = me_as % node_size;                                 \
+        local_size = PE_size - (me_as - local_rank) < node_size ?       \
+                     PE_size - (me_as - local_rank) : node_size;        \
+        leader_pe = me - local_rank * stride;                           \
+                                                                        \
+        /* The sources of all the local PEs must be ready */            \
+        shmem_long_atomic_inc(arrive_pSync, leader_pe);                 \
+                                                                        \
+        if (local_rank == 0) {                                          \
+            shmem_long_wait_until(arrive_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + local_size); \
+            shmem_long_p(arrive_pSync, SHCOLL_SYNC_VALUE, me);          \
+                                                                        \
+            for (i = 1; i < local_size; i++) {                          \
+                shmem_long_p(local_pSync, SHCOLL_SYNC_VALUE + 1, me + i * stride); \
             }                                                           \
+        } else {                                                        \
+            shmem_long_wait_until(local_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + 1); \
+        }                                                               \
                                                                         \
-            shmem_long_p(collect_pSync, SHCOLL_SYNC_VALUE, me);         \
+        /* Every local PE reduces its own block into pWrk of the leader */ \
+        block_offset = reduce_block_offset(local_rank, nelems, local_size); \
+        next_block_offset = reduce_block_offset(local_rank + 1, nelems, local_size); \
+                                                                        \
+        node_array = shmem_ptr(pWrk, leader_pe);                        \
+        local_source = shmem_ptr(source, leader_pe);                    \
+        memcpy(node_array + block_offset, local_source + block_offset,  \
+               (next_block_offset - block_offset) * sizeof(_type));     \
+                                                                        \
+        for (i = 1; i < local_size; i++) {                              \
+            local_source = shmem_ptr(source, leader_pe + i * stride);   \
+            local_##_name##_reduce(node_array + block_offset,           \
+                                   node_array + block_offset,           \
+                                   local_source + block_offset,         \
+                                   next_block_offset - block_offset);   \
+        }                                                               \
+                                                                        \
+        LOAD_STORE_FENCE();                                             \
+        shmem_long_atomic_inc(done_pSync, leader_pe);                   \
+                                                                        \
+        if (local_rank == 0) {                                          \
+            shmem_long_wait_until(done_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + local_size); \
+            shmem_long_p(done_pSync, SHCOLL_SYNC_VALUE, me);            \
+                                                                        \
+            /* Only the leaders talk over the network */                \
+            if (nnodes == 1) {                                          \
+                memcpy(dest, pWrk, nbytes);                             \
+            } else if (nbytes < reduce_rabenseifner_threshold) {        \
+                reduce_helper_rec_dbl_strided(dest, pWrk, nelems, sizeof(_type), \
+                                              local_##_name##_reduce, PE_start, \
+                                              stride * node_size, nnodes, \
+                                              inter_pSync);             \
+            } else {                                                    \
+                reduce_helper_rabenseifner_strided(dest, pWrk, nelems, sizeof(_type), \
+                                                   local_##_name##_reduce, PE_start, \
+                                                   stride * node_size, nnodes, \
+                                                   inter_pSync);        \
+            }                                                           \
+                                                                        \
+            LOAD_STORE_FENCE();                                         \
+            for (i = 1; i < local_size; i++) {                          \
+                shmem_long_p(local_pSync, SHCOLL_SYNC_VALUE + 2, me + i * stride); \
+            }                                                           \
+                                                                        \
+            /* Wait until the local PEs have copied the result */       \
+            shmem_long_wait_until(copied_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + local_size - 1); \
+            shmem_long_p(copied_pSync, SHCOLL_SYNC_VALUE, me);          \
+        } else {                                                        \
+            shmem_long_wait_until(local_pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + 2); \
+            shmem_long_p(local_pSync, SHCOLL_SYNC_VALUE, me);           \
+                                                                        \
+            memcpy(dest, shmem_ptr(dest, leader_pe), nbytes);           \
+            shmem_long_atomic_inc(copied_pSync, leader_pe);             \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    REDUCE_INT_COUNT(_name, _type, hierarchical)
+
+
+/*
+ * MAXLOC and MINLOC: recursive doubling is latency bound, Rabenseifner moves
+ * less data for the long vectors
+ */
+
+#define REDUCE_HELPER_LOC(_name, _type, _op)                            \
+    void                                                                \
+    shcoll_##_name##_to_all(_type *dest, const _type *source,           \
+                            int nreduce, int PE_start,                  \
+                            int logPE_stride, int PE_size,              \
+                            _type *pWrk, long *pSync)                   \
+    {                                                                   \
+        if (nreduce * sizeof(_type) < reduce_rabenseifner_threshold) {  \
+            shcoll_##_name##_to_all_rec_dbl(dest, source, nreduce,      \
+                                            PE_start, logPE_stride,     \
+                                            PE_size, pWrk, pSync);      \
+        } else {                                                        \
+            shcoll_##_name##_to_all_rabenseifner(dest, source, nreduce, \
+                                                 PE_start, logPE_stride, \
+                                                 PE_size, pWrk, pSync); \
+        }                                                               \
+    }
+
+
+/*
+ * Sparse reduction implementation
+ *
+ * The vectors are given as unsorted (index, value) pairs, duplicates are
+ * combined.  The pairs are merged by index with recursive doubling, so the
+ * traffic, pWrk and the local work depend on the number of nonzeros only, and
+ * the result is returned as sorted pairs.  The dense variant writes the
+ * result into a dense vector, which costs O(nreduce) on every PE.  It merges
+ * only while the total number of nonzeros is below the density threshold
+ * and fits into pWrk, otherwise the vectors are expanded in dest and reduced
+ * with Rabenseifner in place.
+ */
+
+#define REDUCE_HELPER_SPARSE(_name, _type, _op)                         \
+    typedef struct {                                                    \
+        int index;                                                      \
+        _type value;                                                    \
+    } _name##_sparse_pair_t;                                            \
+                                                                        \
+    static int                                                          \
+    _name##_sparse_pair_cmp(const void *a, const void *b)               \
+    {                                                                   \
+        const int index_a = ((const _name##_sparse_pair_t *) a)->index; \
+        const int index_b = ((const _name##_sparse_pair_t *) b)->index; \
+                                                                        \
+        return (index_a > index_b) - (index_a < index_b);               \
+    }                                                                   \
+                                                                        \
+    /* Sorts the pairs by index and combines the duplicates */          \
+    inline static size_t                                                \
+    _name##_sparse_normalize(int *dest_indices, _type *dest_values,     \
+                             const int *indices, const _type *values,   \
+                             size_t nnz)                                \
+    {                                                                   \
+        _name##_sparse_pair_t *pairs;                                   \
+        size_t count = 0;                                               \
+        size_t i;                                                       \
+                                                                        \
+        if (nnz == 0) {                                                 \
+            return 0;                                                   \
+        }                                                               \
+                                                                        \
+        pairs = malloc(nnz * sizeof(_name##_sparse_pair_t));            \
+        if (pairs == NULL) {                                            \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", shmem_my_pe()); \
+            exit(-1);                                                   \
+        }                                                               \
+                                                                        \
+        for (i = 0; i < nnz; i++) {                                     \
+            pairs[i].index = indices[i];                                \
+            pairs[i].value = values[i];                                 \
+        }                                                               \
+                                                                        \
+        qsort(pairs, nnz, sizeof(_name##_sparse_pair_t), _name##_sparse_pair_cmp); \
+                                                                        \
+        dest_indices[0] = pairs[0].index;                               \
+        dest_values[0] = pairs[0].value;                                \
+                                                                        \
+        for (i = 1; i < nnz; i++) {                                     \
+            if (pairs[i].index == dest_indices[count]) {                \
+                dest_values[count] = _op(dest_values[count], pairs[i].value); \
+            } else {                                                    \
+                count++;                                                \
+                dest_indices[count] = pairs[i].index;                   \
+                dest_values[count] = pairs[i].value;                    \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        free(pairs);                                                    \
+        return count + 1;                                               \
+    }                                                                   \
+                                                                        \
+    /* Merges two sorted pair lists, dest must not alias the sources */ \
+    inline static size_t                                                \
+    _name##_sparse_merge(int *dest_indices, _type *dest_values,         \
+                         const int *indices1, const _type *values1, size_t nnz1, \
+                         const int *indices2, const _type *values2, size_t nnz2) \
+    {                                                                   \
+        size_t i = 0;                                                   \
+        size_t j = 0;                                                   \
+        size_t count = 0;                                               \
+                                                                        \
+        while (i < nnz1 && j < nnz2) {                                  \
+            if (indices1[i] < indices2[j]) {                            \
+                dest_indices[count] = indices1[i];                      \
+                dest_values[count++] = values1[i++];                    \
+            } else if (indices1[i] > indices2[j]) {                     \
+                dest_indices[count] = indices2[j];                      \
+                dest_values[count++] = values2[j++];                    \
+            } else {                                                    \
+                dest_indices[count] = indices1[i];                      \
+                dest_values[count++] = _op(values1[i], values2[j]);     \
+                i++;                                                    \
+                j++;                                                    \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        for (; i < nnz1; i++) {                                         \
+            dest_indices[count] = indices1[i];                          \
+            dest_values[count++] = values1[i];                          \
+        }                                                               \
+                                                                        \
+        for (; j < nnz2; j++) {                                         \
+            dest_indices[count] = indices2[j];                          \
+            dest_values[count++] = values2[j];                          \
+        }                                                               \
+                                                                        \
+        return count;                                                   \
+    }                                                                   \
+                                                                        \
+    /* Pairs are published in pWrk: values first, indices after them */ \
+    inline static void                                                  \
+    _name##_sparse_publish(_type *pWrk, const int *indices,             \
+                           const _type *values, size_t nnz)             \
+    {                                                                   \
+        memcpy(pWrk, values, nnz * sizeof(_type));                      \
+        memcpy(pWrk + nnz, indices, nnz * sizeof(int));                 \
+    }                                                                   \
+                                                                        \
+    inline static void                                                  \
+    _name##_sparse_fetch(int *indices, _type *values, const _type *pWrk, \
+                         size_t nnz, int pe)                            \
+    {                                                                   \
+        shmem_getmem_nbi(values, pWrk, nnz * sizeof(_type), pe);        \
+        shmem_getmem_nbi(indices, pWrk + nnz, nnz * sizeof(int), pe);   \
+        shmem_quiet();                                                  \
+    }                                                                   \
+                                                                        \
+    /*                                                                  \
+     * Merges the pairs of all the PEs into dest_indices and dest_values, \
+     * which hold max_nnz pairs, and returns their number.  pSync[0..2)  \
+     * are used by the fold, pSync[2..2+2*PE_SIZE_LOG) by the rounds.    \
+     */                                                                 \
+    inline static size_t                                                \
+    _name##_sparse_merge_all(int *dest_indices, _type *dest_values,     \
+                             const int *indices, const _type *values,   \
+                             size_t nnz, size_t max_nnz,                \
+                             int PE_start, int logPE_stride, int PE_size, \
+                             _type *pWrk, long *pSync)                  \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+                                                                        \
+        long *fold_pSync = pSync;                                       \
+        long *fold_ack_pSync = pSync + 1;                               \
+        long *ready_pSync = pSync + 2;                                  \
+        long *ack_pSync = pSync + 2 + PE_SIZE_LOG;                      \
+                                                                        \
+        size_t recv_nnz;                                                \
+        size_t my_nnz;                                                  \
+                                                                        \
+        int *index_buffer;                                              \
+        _type *value_buffer;                                            \
+        int *my_indices = dest_indices;                                 \
+        _type *my_values = dest_values;                                 \
+        int *recv_indices;                                              \
+        _type *recv_values;                                             \
+        int *merged_indices;                                            \
+        _type *merged_values;                                           \
+        int *swap_indices;                                              \
+        _type *swap_values;                                             \
+                                                                        \
+        int xchg_peer_p2s;                                              \
+        int xchg_peer_pe;                                               \
+        int peer_pe;                                                    \
+        int mask;                                                       \
+        int round;                                                      \
+                                                                        \
+        /* Power 2 set */                                               \
+        int me_p2s;                                                     \
+        int p2s_size;                                                   \
+                                                                        \
+        /* Received and merged pairs, the own ones start in dest */     \
+        index_buffer = malloc(2 * (max_nnz + 1) * sizeof(int));         \
+        value_buffer = malloc(2 * (max_nnz + 1) * sizeof(_type));       \
+        if (index_buffer == NULL || value_buffer == NULL) {             \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
+        }                                                               \
+                                                                        \
+        recv_indices = index_buffer;                                    \
+        recv_values = value_buffer;                                     \
+        merged_indices = recv_indices + (max_nnz + 1);                  \
+        merged_values = recv_values + (max_nnz + 1);                    \
+                                                                        \
+        my_nnz = _name##_sparse_normalize(my_indices, my_values, indices, \
+                                          values, nnz);                 \
+                                                                        \
+        /* Find the greatest power of 2 lower than PE_size */           \
+        for (p2s_size = 1; p2s_size * 2 <= PE_size; p2s_size *= 2);     \
+                                                                        \
+        /* Check if the current PE belongs to the power 2 set */        \
+        me_p2s = me_as * p2s_size / PE_size;                            \
+        if ((me_p2s * PE_size + p2s_size - 1) / p2s_size != me_as) {    \
+            me_p2s = -1;                                                \
         }                                                               \
                                                                         \
-        /* Check if the current PE should wait/send data to the peer */ \
         if (me_p2s == -1) {                                             \
-            /* Wait until the peer PE sends the data */                 \
-            shmem_long_wait_until(pSync + 1, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1); \
-            shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE, me);             \
-        } else if ((me_as + 1) * p2s_size / PE_size == me_p2s) {        \
-            peer = PE_start + (me_as + 1) * stride;                     \
-            shmem_putmem(dest, dest, nelems * sizeof(_type), peer);     \
-            shmem_fence();                                              \
-            shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE + 1, peer);       \
+            /* Hand over the pairs to the peer and wait for the result */ \
+            peer_pe = PE_start + (me_as - 1) * stride;                  \
+                                                                        \
+            _name##_sparse_publish(pWrk, my_indices, my_values, my_nnz); \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE + 1 + (long) my_nnz, peer_pe); \
+                                                                        \
+            shmem_long_wait_until(fold_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+            my_nnz = (size_t) (*fold_pSync - SHCOLL_SYNC_VALUE - 1);    \
+            shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);            \
+                                                                        \
+            _name##_sparse_fetch(my_indices, my_values, pWrk, my_nnz, peer_pe); \
+            shmem_long_p(fold_ack_pSync, SHCOLL_SYNC_VALUE + 1, peer_pe); \
+        } else {                                                        \
+            /* Merge the pairs of the PE outside the power 2 set */     \
+            if ((me_as + 1) * p2s_size / PE_size == me_p2s) {           \
+                peer_pe = PE_start + (me_as + 1) * stride;              \
+                                                                        \
+                shmem_long_wait_until(fold_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+                recv_nnz = (size_t) (*fold_pSync - SHCOLL_SYNC_VALUE - 1); \
+                shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE, me);        \
+                                                                        \
+                _name##_sparse_fetch(recv_indices, recv_values, pWrk, recv_nnz, peer_pe); \
+                my_nnz = _name##_sparse_merge(merged_indices, merged_values, \
+                                              my_indices, my_values, my_nnz, \
+                                              recv_indices, recv_values, recv_nnz); \
+                                                                        \
+                swap_indices = my_indices;                              \
+                my_indices = merged_indices;                            \
+                merged_indices = swap_indices;                          \
+                                                                        \
+                swap_values = my_values;                                \
+                my_values = merged_values;                              \
+                merged_values = swap_values;                            \
+            }                                                           \
+                                                                        \
+            /* Recursive doubling, only the pairs are exchanged */      \
+            for (mask = 0x1, round = 0; mask < p2s_size; mask <<= 1, round++) { \
+                xchg_peer_p2s = me_p2s ^ mask;                          \
+                xchg_peer_pe = PE_start + stride * ((xchg_peer_p2s * PE_size + p2s_size - 1) / p2s_size); \
+                                                                        \
+                _name##_sparse_publish(pWrk, my_indices, my_values, my_nnz); \
+                shmem_long_p(ready_pSync + round, SHCOLL_SYNC_VALUE + 1 + (long) my_nnz, xchg_peer_pe); \
+                                                                        \
+                shmem_long_wait_until(ready_pSync + round, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+                recv_nnz = (size_t) (ready_pSync[round] - SHCOLL_SYNC_VALUE - 1); \
+                shmem_long_p(ready_pSync + round, SHCOLL_SYNC_VALUE, me); \
+                                                                        \
+                _name##_sparse_fetch(recv_indices, recv_values, pWrk, recv_nnz, xchg_peer_pe); \
+                shmem_long_p(ack_pSync + round, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe); \
+                                                                        \
+                my_nnz = _name##_sparse_merge(merged_indices, merged_values, \
+                                              my_indices, my_values, my_nnz, \
+                                              recv_indices, recv_values, recv_nnz); \
+                                                                        \
+                swap_indices = my_indices;                              \
+                my_indices = merged_indices;                            \
+                merged_indices = swap_indices;                          \
+                                                                        \
+                swap_values = my_values;                                \
+                my_values = merged_values;                              \
+                merged_values = swap_values;                            \
+                                                                        \
+                /* Wait until the peer has read the published pairs */  \
+                shmem_long_wait_until(ack_pSync + round, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+                shmem_long_p(ack_pSync + round, SHCOLL_SYNC_VALUE, me); \
+            }                                                           \
+                                                                        \
+            /* Hand over the result to the PE outside the power 2 set */ \
+            if ((me_as + 1) * p2s_size / PE_size == me_p2s) {           \
+                peer_pe = PE_start + (me_as + 1) * stride;              \
+                                                                        \
+                _name##_sparse_publish(pWrk, my_indices, my_values, my_nnz); \
+                shmem_long_p(fold_pSync, SHCOLL_SYNC_VALUE + 1 + (long) my_nnz, peer_pe); \
+                                                                        \
+                shmem_long_wait_until(fold_ack_pSync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE); \
+                shmem_long_p(fold_ack_pSync, SHCOLL_SYNC_VALUE, me);    \
+            }                                                           \
         }                                                               \
                                                                         \
-        if (tmp_array != NULL) {                                        \
-            free(tmp_array);                                            \
+        if (my_indices != dest_indices) {                               \
+            memcpy(dest_indices, my_indices, my_nnz * sizeof(int));     \
+            memcpy(dest_values, my_values, my_nnz * sizeof(_type));     \
+        }                                                               \
+                                                                        \
+        free(index_buffer);                                             \
+        free(value_buffer);                                             \
+        return my_nnz;                                                  \
+    }                                                                   \
+                                                                        \
+    int                                                                 \
+    shcoll_##_name##_to_all_sparse_pairs(int *dest_indices, _type *dest_values, \
+                                         const int *indices, const _type *values, \
+                                         int nnz, int max_nnz,          \
+                                         int PE_start, int logPE_stride, \
+                                         int PE_size, _type *pWrk, long *pSync) \
+    {                                                                   \
+        return (int) _name##_sparse_merge_all(dest_indices, dest_values, \
+                                              indices, values,          \
+                                              (size_t) nnz, (size_t) max_nnz, \
+                                              PE_start, logPE_stride, PE_size, \
+                                              pWrk, pSync);             \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_to_all_sparse(_type *dest, const int *indices,     \
+                                   const _type *values, int nnz, int nreduce, \
+                                   int max_nnz, int PE_start, int logPE_stride, \
+                                   int PE_size, _type *pWrk, long *pSync) \
+    {                                                                   \
+        const int me = shmem_my_pe();                                   \
+                                                                        \
+        /* pSync[0 .. SHCOLL_REDUCE_SYNC_SIZE) is used to count the nonzeros, \
+         * the rest by the sparse or the dense reduction */             \
+        long *sparse_pSync = pSync + SHCOLL_REDUCE_SYNC_SIZE;           \
+                                                                        \
+        long *count = (long *) pWrk;                                    \
+        size_t total;                                                   \
+        size_t result_nnz;                                              \
+        size_t i;                                                       \
+                                                                        \
+        int *result_indices;                                            \
+        _type *result_values;                                           \
+                                                                        \
+        /* Upper bound of the number of nonzeros in the result */       \
+        count[0] = nnz;                                                 \
+        reduce_helper_rec_dbl(count + 1, count, 1, sizeof(long),        \
+                              local_long_sum_reduce, PE_start, logPE_stride, \
+                              PE_size, pSync);                          \
+        total = (size_t) count[1];                                      \
+                                                                        \
+        /* Too dense to be worth merging, or does not fit into pWrk */  \
+        if (total >= reduce_sparse_density * nreduce || total > (size_t) max_nnz) { \
+            memset(dest, 0, nreduce * sizeof(_type));                   \
+            for (i = 0; i < (size_t) nnz; i++) {                        \
+                dest[indices[i]] = _op(dest[indices[i]], values[i]);    \
+            }                                                           \
+                                                                        \
+            reduce_helper_rabenseifner(dest, dest, nreduce, sizeof(_type), \
+                                       local_##_name##_reduce, PE_start, \
+                                       logPE_stride, PE_size, sparse_pSync); \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        result_indices = malloc((total + 1) * sizeof(int));             \
+        result_values = malloc((total + 1) * sizeof(_type));            \
+        if (result_indices == NULL || result_values == NULL) {          \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
+        }                                                               \
+                                                                        \
+        result_nnz = _name##_sparse_merge_all(result_indices, result_values, \
+                                              indices, values, (size_t) nnz, \
+                                              total, PE_start, logPE_stride, \
+                                              PE_size, pWrk, sparse_pSync); \
+                                                                        \
+        memset(dest, 0, nreduce * sizeof(_type));                       \
+        for (i = 0; i < result_nnz; i++) {                              \
+            dest[result_indices[i]] = result_values[i];                 \
         }                                                               \
+                                                                        \
+        free(result_indices);                                           \
+        free(result_values);                                            \
     }
 
 
 /*
- * Supported reduction operations
+ * Batched reductions
+ *
+ * The packed vectors are reduced as a single element of batch->nbytes bytes,
+ * the operator applies the operator of every segment in turn.  The batch is
+ * passed to it as the context of the recursive doubling engine.
  */
 
-#define AND_OP(A, B)  ((A) & (B))
-#define MAX_OP(A, B)  ((A) > (B) ? (A) : (B))
-#define MIN_OP(A, B)  ((A) < (B) ? (A) : (B))
-#define SUM_OP(A, B)  ((A) + (B))
-#define PROD_OP(A, B) ((A) * (B))
-#define OR_OP(A, B)   ((A) | (B))
-#define XOR_OP(A, B)  ((A) ^ (B))
+#define REDUCE_BATCH_ALIGN 16
+
+typedef struct reduce_batch_segment {
+    void *dest;
+    size_t offset;
+    size_t nreduce;
+    size_t elem_size;
+    shcoll_reduce_op_t op;
+} reduce_batch_segment_t;
+
+struct shcoll_reduce_batch {
+    void *source;               /* symmetric */
+    void *dest;                 /* symmetric */
+    size_t max_bytes;
+    size_t nbytes;
+    reduce_batch_segment_t *segments;
+    int nsegments;
+    int max_segments;
+};
+
+static void
+reduce_batch_op(const void *ctx, void *dest, const void *src1, const void *src2,
+                size_t nelems)
+{
+    const shcoll_reduce_batch_t *batch = ctx;
+    const reduce_batch_segment_t *segment;
+    int i;
+
+    for (i = 0; i < batch->nsegments; i++) {
+        segment = &batch->segments[i];
+        segment->op((char *) dest + segment->offset,
+                    (const char *) src1 + segment->offset,
+                    (const char *) src2 + segment->offset,
+                    segment->nreduce);
+    }
+}
+
+shcoll_reduce_batch_t *
+shcoll_reduce_batch_create(size_t max_bytes)
+{
+    shcoll_reduce_batch_t *batch = malloc(sizeof(shcoll_reduce_batch_t));
+
+    if (batch == NULL) {
+        /* TODO: raise error */
+        fprintf(stderr, "PE %d: Cannot allocate memory!\n", shmem_my_pe());
+        exit(-1);
+    }
+
+    batch->source = shmem_malloc(max_bytes);
+    batch->dest = shmem_malloc(max_bytes);
+    if (max_bytes != 0 && (batch->source == NULL || batch->dest == NULL)) {
+        /* TODO: raise error */
+        fprintf(stderr, "PE %d: Cannot allocate memory!\n", shmem_my_pe());
+        exit(-1);
+    }
+
+    batch->max_bytes = max_bytes;
+    batch->nbytes = 0;
+    batch->segments = NULL;
+    batch->nsegments = 0;
+    batch->max_segments = 0;
+
+    return batch;
+}
+
+void
+shcoll_reduce_batch_destroy(shcoll_reduce_batch_t *batch)
+{
+    shmem_free(batch->source);
+    shmem_free(batch->dest);
+    free(batch->segments);
+    free(batch);
+}
+
+void
+shcoll_reduce_batch_begin(shcoll_reduce_batch_t *batch)
+{
+    batch->nbytes = 0;
+    batch->nsegments = 0;
+}
+
+void
+shcoll_reduce_batch_add(shcoll_reduce_batch_t *batch, void *dest,
+                        const void *source, int nreduce, size_t elem_size,
+                        shcoll_reduce_op_t op)
+{
+    const size_t nbytes = nreduce * elem_size;
+    const size_t offset = (batch->nbytes + REDUCE_BATCH_ALIGN - 1) /
+                          REDUCE_BATCH_ALIGN * REDUCE_BATCH_ALIGN;
+    reduce_batch_segment_t *segment;
+
+    if (offset + nbytes > batch->max_bytes) {
+        /* TODO: raise error */
+        fprintf(stderr, "PE %d: Reduce batch is full!\n", shmem_my_pe());
+        exit(-1);
+    }
+
+    if (batch->nsegments == batch->max_segments) {
+        batch->max_segments = batch->max_segments == 0 ? 8 : batch->max_segments * 2;
+        batch->segments = realloc(batch->segments,
+                                  batch->max_segments * sizeof(reduce_batch_segment_t));
+        if (batch->segments == NULL) {
+            /* TODO: raise error */
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", shmem_my_pe());
+            exit(-1);
+        }
+    }
+
+    segment = &batch->segments[batch->nsegments++];
+    segment->dest = dest;
+    segment->offset = offset;
+    segment->nreduce = (size_t) nreduce;
+    segment->elem_size = elem_size;
+    segment->op = op;
+
+    memcpy((char *) batch->source + offset, source, nbytes);
+    batch->nbytes = offset + nbytes;
+}
+
+void
+shcoll_reduce_batch_end(shcoll_reduce_batch_t *batch, int PE_start,
+                        int logPE_stride, int PE_size, long *pSync)
+{
+    const reduce_batch_segment_t *segment;
+    int i;
+
+    if (batch->nbytes == 0) {
+        return;
+    }
+
+    reduce_helper_rec_dbl_strided_ctx(batch->dest, batch->source, 1, batch->nbytes,
+                                      reduce_batch_op, batch,
+                                      PE_start, 1 << logPE_stride, PE_size, pSync);
+
+    for (i = 0; i < batch->nsegments; i++) {
+        segment = &batch->segments[i];
+        memcpy(segment->dest, (char *) batch->dest + segment->offset,
+               segment->nreduce * segment->elem_size);
+    }
+
+    batch->nbytes = 0;
+    batch->nsegments = 0;
+}
+
+#define REDUCE_HELPER_BATCH_ADD(_name, _type, _op)                      \
+    void                                                                \
+    shcoll_reduce_batch_add_##_name(shcoll_reduce_batch_t *batch,       \
+                                    _type *dest, const _type *source,   \
+                                    int nreduce)                        \
+    {                                                                   \
+        shcoll_reduce_batch_add(batch, dest, source, nreduce,           \
+                                sizeof(_type), local_##_name##_reduce); \
+    }
+
 
 /*
- * Definitions for all reductions
+ * User-defined reductions
  */
 
-#define SHCOLL_REDUCE_DEFINE(_name)                             \
-    /* AND operation */                                         \
-    _name(short_and,        short,      AND_OP)                 \
-        _name(int_and,          int,        AND_OP)             \
-        _name(long_and,         long,       AND_OP)             \
-        _name(longlong_and,     long long,  AND_OP)             \
-                                                                \
-        /* MAX operation */                                     \
-        _name(short_max,        short,          MAX_OP)         \
-        _name(int_max,          int,            MAX_OP)         \
-        _name(double_max,       double,         MAX_OP)         \
-        _name(float_max,        float,          MAX_OP)         \
-        _name(long_max,         long,           MAX_OP)         \
-        _name(longdouble_max,   long double,    MAX_OP)         \
-        _name(longlong_max,     long long,      MAX_OP)         \
-                                                                \
-        /* MIN operation */                                     \
-        _name(short_min,        short,          MIN_OP)         \
-        _name(int_min,          int,            MIN_OP)         \
-        _name(double_min,       double,         MIN_OP)         \
-        _name(float_min,        float,          MIN_OP)         \
-        _name(long_min,         long,           MIN_OP)         \
-        _name(longdouble_min,   long double,    MIN_OP)         \
-        _name(longlong_min,     long long,      MIN_OP)         \
-                                                                \
-        /* SUM operation */                                     \
-        _name(complexd_sum,     double _Complex,    SUM_OP)     \
-        _name(complexf_sum,     float _Complex,     SUM_OP)     \
-        _name(short_sum,        short,              SUM_OP)     \
-        _name(int_sum,          int,                SUM_OP)     \
-        _name(double_sum,       double,             SUM_OP)     \
-        _name(float_sum,        float,              SUM_OP)     \
-        _name(long_sum,         long,               SUM_OP)     \
-        _name(longdouble_sum,   long double,        SUM_OP)     \
-        _name(longlong_sum,     long long,          SUM_OP)     \
-                                                                \
-        /* PROD operation */                                    \
-        _name(complexd_prod,    double _Complex,    PROD_OP)    \
-        _name(complexf_prod,    float _Complex,     PROD_OP)    \
-        _name(short_prod,       short,              PROD_OP)    \
-        _name(int_prod,         int,                PROD_OP)    \
-        _name(double_prod,      double,             PROD_OP)    \
-        _name(float_prod,       float,              PROD_OP)    \
-        _name(long_prod,        long,               PROD_OP)    \
-        _name(longdouble_prod,  long double,        PROD_OP)    \
-        _name(longlong_prod,    long long,          PROD_OP)    \
-                                                                \
-        /* OR operation */                                      \
-        _name(short_or,         short,      OR_OP)              \
-        _name(int_or,           int,        OR_OP)              \
-        _name(long_or,          long,       OR_OP)              \
-        _name(longlong_or,      long long,  OR_OP)              \
-                                                                \
-        /* XOR operation */                                     \
-        _name(short_xor,        short,      XOR_OP)             \
-        _name(int_xor,          int,        XOR_OP)             \
-        _name(long_xor,         long,       XOR_OP)             \
-        _name(longlong_xor,     long long,  XOR_OP)
+#define REDUCE_USER_DEFINITION(_algorithm)                              \
+    void                                                                \
+    shcoll_reduce_user_to_all_##_algorithm##_size(void *dest,           \
+                                                  const void *source,   \
+                                                  size_t nreduce,       \
+                                                  size_t elem_size,     \
+                                                  shcoll_reduce_op_t op, \
+                                                  int PE_start,         \
+                                                  int logPE_stride,     \
+                                                  int PE_size,          \
+                                                  void *pWrk, long *pSync) \
+    {                                                                   \
+        reduce_helper_##_algorithm(dest, source, nreduce, elem_size, op, \
+                                   PE_start, logPE_stride, PE_size,     \
+                                   pSync);                              \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_reduce_user_to_all_##_algorithm(void *dest, const void *source, \
+                                           int nreduce, size_t elem_size, \
+                                           shcoll_reduce_op_t op,       \
+                                           int PE_start, int logPE_stride, \
+                                           int PE_size,                 \
+                                           void *pWrk, long *pSync)     \
+    {                                                                   \
+        shcoll_reduce_user_to_all_##_algorithm##_size(dest, source,     \
+                                                      (size_t) nreduce, \
+                                                      elem_size, op,    \
+                                                      PE_start, logPE_stride, \
+                                                      PE_size, pWrk, pSync); \
+    }
+
+REDUCE_USER_DEFINITION(binomial)
+REDUCE_USER_DEFINITION(rec_dbl)
+REDUCE_USER_DEFINITION(rabenseifner)
 
 
 /* @formatter:off */
@@ -743,16 +2887,50 @@
         SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_LOCAL)
         SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_LINEAR)
         SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_BINOMIAL)
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_PIPELINED)
         SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_REC_DBL)
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_REC_MULT)
         SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_RABENSEIFNER)
         SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_RABENSEIFNER2)
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_ROOTED_KNOMIAL)
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_KNOMIAL)
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_ROOTED_RABENSEIFNER)
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_HIERARCHICAL)
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_BATCH_ADD)
+        SHCOLL_REDUCE_ATOMIC_DEFINE(REDUCE_HELPER_ATOMIC)
+
+        REDUCE_HELPER_RABENSEIFNER_WIRE(float_sum, float, fp16, shcoll_fp16_t, float_to_fp16, fp16_to_float)
+        REDUCE_HELPER_RABENSEIFNER_WIRE(float_sum, float, bf16, shcoll_bf16_t, float_to_bf16, bf16_to_float)
+        REDUCE_HELPER_RABENSEIFNER_WIRE(double_sum, double, fp32, float, DOUBLE_TO_FP32, FP32_TO_DOUBLE)
+        REDUCE_HELPER_RABENSEIFNER_WIRE(double_sum, double, fp16, shcoll_fp16_t, DOUBLE_TO_FP16, fp16_to_float)
+        REDUCE_HELPER_RABENSEIFNER_WIRE(double_sum, double, bf16, shcoll_bf16_t, DOUBLE_TO_BF16, bf16_to_float)
+
+        REDUCE_HELPER_LOC(double_maxloc, shcoll_double_int_t, MAXLOC_OP)
+        REDUCE_HELPER_LOC(float_maxloc, shcoll_float_int_t, MAXLOC_OP)
+        REDUCE_HELPER_LOC(long_maxloc, shcoll_long_int_t, MAXLOC_OP)
+        REDUCE_HELPER_LOC(int_maxloc, shcoll_int_int_t, MAXLOC_OP)
+        REDUCE_HELPER_LOC(double_minloc, shcoll_double_int_t, MINLOC_OP)
+        REDUCE_HELPER_LOC(float_minloc, shcoll_float_int_t, MINLOC_OP)
+        REDUCE_HELPER_LOC(long_minloc, shcoll_long_int_t, MINLOC_OP)
+        REDUCE_HELPER_LOC(int_minloc, shcoll_int_int_t, MINLOC_OP)
+
+        REDUCE_HELPER_SPARSE(float_sum, float, SUM_OP)
+        REDUCE_HELPER_SPARSE(double_sum, double, SUM_OP)
 #else
         REDUCE_HELPER_LOCAL(int_sum, int, SUM_OP)
         REDUCE_HELPER_LINEAR(int_sum, int, SUM_OP)
         REDUCE_HELPER_BINOMIAL(int_sum, int, SUM_OP)
+        REDUCE_HELPER_PIPELINED(int_sum, int, SUM_OP)
         REDUCE_HELPER_REC_DBL(int_sum, int, SUM_OP)
+        REDUCE_HELPER_REC_MULT(int_sum, int, SUM_OP)
         REDUCE_HELPER_RABENSEIFNER(int_sum, int, SUM_OP)
         REDUCE_HELPER_RABENSEIFNER2(int_sum, int, SUM_OP)
+        REDUCE_HELPER_ROOTED_KNOMIAL(int_sum, int, SUM_OP)
+        REDUCE_HELPER_KNOMIAL(int_sum, int, SUM_OP)
+        REDUCE_HELPER_ROOTED_RABENSEIFNER(int_sum, int, SUM_OP)
+        REDUCE_HELPER_HIERARCHICAL(int_sum, int, SUM_OP)
+        REDUCE_HELPER_BATCH_ADD(int_sum, int, SUM_OP)
+        REDUCE_HELPER_ATOMIC(int_sum, int, SUM)
 #endif
 
 /* @formatter:on */
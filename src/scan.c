@@ -0,0 +1,312 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#include "shcoll.h"
+#include "util/reduce-ops.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/*
+ * pSync layout: [0, PE_SIZE_LOG) are "data ready" flags, one per round,
+ * [PE_SIZE_LOG, 2 * PE_SIZE_LOG) are the matching "data read" acks.  The
+ * last round slot is never reached by the algorithms and is used by the
+ * shift step of exscan.
+ */
+#define SCAN_READY(_pSync, _round) ((_pSync) + (_round))
+#define SCAN_ACK(_pSync, _round)   ((_pSync) + PE_SIZE_LOG + (_round))
+#define SCAN_SHIFT_ROUND           (PE_SIZE_LOG - 1)
+
+/*
+ * Exclusive scan is computed as an inclusive scan of the input shifted by one
+ * PE: every PE except the first one gets the source of its left neighbour.
+ */
+inline static void
+exscan_shift(void *dest, const void *source, size_t nbytes, int PE_start,
+             int logPE_stride, int PE_size, long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+    const int me_as = (me - PE_start) / stride;
+
+    long *ready = SCAN_READY(pSync, SCAN_SHIFT_ROUND);
+    long *ack = SCAN_ACK(pSync, SCAN_SHIFT_ROUND);
+    void *tmp = NULL;
+
+    if (me_as + 1 < PE_size) {
+        shmem_long_p(ready, SHCOLL_SYNC_VALUE + 1, me + stride);
+    }
+
+    if (me_as > 0) {
+        tmp = malloc(nbytes);
+        if (tmp == NULL) {
+            /* TODO: raise error */
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);
+            exit(-1);
+        }
+
+        shmem_long_wait_until(ready, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(ready, SHCOLL_SYNC_VALUE, me);
+
+        shmem_getmem(tmp, source, nbytes, me - stride);
+        shmem_long_p(ack, SHCOLL_SYNC_VALUE + 1, me - stride);
+    }
+
+    /* Source can be overwritten only after the right neighbour has read it */
+    if (me_as + 1 < PE_size) {
+        shmem_long_wait_until(ack, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(ack, SHCOLL_SYNC_VALUE, me);
+    }
+
+    if (tmp != NULL) {
+        memcpy(dest, tmp, nbytes);
+        free(tmp);
+    }
+}
+
+/*
+ * Recursive doubling (Hillis-Steele) scan implementation
+ */
+
+#define SCAN_HELPER_REC_DBL(_name, _type, _op)                          \
+    /* Inclusive scan over the PEs [first, PE_size) of the active set,  \
+     * dest already holds the contribution of the current PE */         \
+    inline static void                                                  \
+    scan_##_name##_helper_rec_dbl(_type *dest, size_t nreduce,          \
+                                  int first, int PE_start,              \
+                                  int logPE_stride, int PE_size,        \
+                                  long *pSync)                          \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+        const int me_scan = me_as - first;                              \
+        const int scan_size = PE_size - first;                          \
+        const size_t nbytes = sizeof(_type) * nreduce;                  \
+                                                                        \
+        _type *tmp_array;                                               \
+        int has_recv;                                                   \
+        int has_send;                                                   \
+        int distance;                                                   \
+        int round;                                                      \
+                                                                        \
+        if (me_scan < 0 || scan_size <= 1) {                            \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        tmp_array = malloc(nbytes);                                     \
+        if (tmp_array == NULL) {                                        \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
+        }                                                               \
+                                                                        \
+        for (distance = 1, round = 0; distance < scan_size; distance <<= 1, round++) { \
+            has_recv = me_scan - distance >= 0;                         \
+            has_send = me_scan + distance < scan_size;                  \
+                                                                        \
+            /* Notify the right peer that the partial result is ready */ \
+            if (has_send) {                                             \
+                shmem_long_p(SCAN_READY(pSync, round), SHCOLL_SYNC_VALUE + 1, \
+                             me + distance * stride);                   \
+            }                                                           \
+                                                                        \
+            if (has_recv) {                                             \
+                shmem_long_wait_until(SCAN_READY(pSync, round), SHMEM_CMP_NE, \
+                                      SHCOLL_SYNC_VALUE);               \
+                shmem_long_p(SCAN_READY(pSync, round), SHCOLL_SYNC_VALUE, me); \
+                                                                        \
+                shmem_getmem(tmp_array, dest, nbytes, me - distance * stride); \
+                shmem_long_p(SCAN_ACK(pSync, round), SHCOLL_SYNC_VALUE + 1, \
+                             me - distance * stride);                   \
+            }                                                           \
+                                                                        \
+            /* Wait until the right peer has read the partial result */ \
+            if (has_send) {                                             \
+                shmem_long_wait_until(SCAN_ACK(pSync, round), SHMEM_CMP_NE, \
+                                      SHCOLL_SYNC_VALUE);               \
+                shmem_long_p(SCAN_ACK(pSync, round), SHCOLL_SYNC_VALUE, me); \
+            }                                                           \
+                                                                        \
+            if (has_recv) {                                             \
+                local_##_name##_reduce(dest, tmp_array, dest, nreduce); \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        free(tmp_array);                                                \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_scan_rec_dbl(_type *dest, const _type *source,     \
+                                  int nreduce, int PE_start,            \
+                                  int logPE_stride, int PE_size,        \
+                                  _type *pWrk, long *pSync)             \
+    {                                                                   \
+        if (dest != source) {                                           \
+            memcpy(dest, source, sizeof(_type) * nreduce);              \
+        }                                                               \
+                                                                        \
+        scan_##_name##_helper_rec_dbl(dest, nreduce, 0, PE_start,       \
+                                      logPE_stride, PE_size, pSync);    \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_exscan_rec_dbl(_type *dest, const _type *source,   \
+                                    int nreduce, int PE_start,          \
+                                    int logPE_stride, int PE_size,      \
+                                    _type *pWrk, long *pSync)           \
+    {                                                                   \
+        exscan_shift(dest, source, sizeof(_type) * nreduce, PE_start,   \
+                     logPE_stride, PE_size, pSync);                     \
+                                                                        \
+        scan_##_name##_helper_rec_dbl(dest, nreduce, 1, PE_start,       \
+                                      logPE_stride, PE_size, pSync);    \
+    }
+
+/*
+ * Up/down sweep (Brent-Kung) scan implementation
+ *
+ * Each PE takes part in the up sweep while (me + 1) is divisible by
+ * 2 * distance, and is the target of exactly one message of the down sweep,
+ * at the round given by the number of trailing zeros of (me + 1).  Rounds
+ * in which a PE sends and receives are therefore disjoint, so the same
+ * ready/ack slots are used for both sweeps.
+ */
+
+#define SCAN_HELPER_UP_DOWN_SWEEP(_name, _type, _op)                    \
+    inline static void                                                  \
+    scan_##_name##_helper_up_down_sweep(_type *dest, size_t nreduce,    \
+                                        int first, int PE_start,        \
+                                        int logPE_stride, int PE_size,  \
+                                        long *pSync)                    \
+    {                                                                   \
+        const int stride = 1 << logPE_stride;                           \
+        const int me = shmem_my_pe();                                   \
+        const int me_as = (me - PE_start) / stride;                     \
+        const int me_scan = me_as - first;                              \
+        const int scan_size = PE_size - first;                          \
+        const size_t nbytes = sizeof(_type) * nreduce;                  \
+                                                                        \
+        _type *tmp_array;                                               \
+        int distance;                                                   \
+        int round;                                                      \
+        int peer;                                                       \
+                                                                        \
+        /* Round in which the current PE hands over its partial result */ \
+        int my_round;                                                   \
+                                                                        \
+        if (me_scan < 0 || scan_size <= 1) {                            \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        tmp_array = malloc(nbytes);                                     \
+        if (tmp_array == NULL) {                                        \
+            /* TODO: raise error */                                     \
+            fprintf(stderr, "PE %d: Cannot allocate memory!\n", me);    \
+            exit(-1);                                                   \
+        }                                                               \
+                                                                        \
+        /* Up sweep: reduce partial results from the left subtrees */   \
+        for (distance = 1, round = 0; ((me_scan + 1) & distance) == 0 && distance < scan_size; \
+             distance <<= 1, round++) {                                 \
+            peer = me - distance * stride;                              \
+                                                                        \
+            shmem_long_wait_until(SCAN_READY(pSync, round), SHMEM_CMP_NE, \
+                                  SHCOLL_SYNC_VALUE);                   \
+            shmem_long_p(SCAN_READY(pSync, round), SHCOLL_SYNC_VALUE, me); \
+                                                                        \
+            shmem_getmem(tmp_array, dest, nbytes, peer);                \
+            shmem_long_p(SCAN_ACK(pSync, round), SHCOLL_SYNC_VALUE + 1, peer); \
+                                                                        \
+            local_##_name##_reduce(dest, tmp_array, dest, nreduce);     \
+        }                                                               \
+                                                                        \
+        my_round = round;                                               \
+                                                                        \
+        /* Hand over the partial result to the right sibling */         \
+        if (me_scan + distance < scan_size) {                           \
+            peer = me + distance * stride;                              \
+                                                                        \
+            shmem_long_p(SCAN_READY(pSync, my_round), SHCOLL_SYNC_VALUE + 1, peer); \
+                                                                        \
+            shmem_long_wait_until(SCAN_ACK(pSync, my_round), SHMEM_CMP_NE, \
+                                  SHCOLL_SYNC_VALUE);                   \
+            shmem_long_p(SCAN_ACK(pSync, my_round), SHCOLL_SYNC_VALUE, me); \
+        }                                                               \
+                                                                        \
+        /* Down sweep: get the prefix of everything on the left */      \
+        if (me_scan + 1 != distance) {                                  \
+            peer = me - distance * stride;                              \
+                                                                        \
+            shmem_long_wait_until(SCAN_READY(pSync, my_round), SHMEM_CMP_NE, \
+                                  SHCOLL_SYNC_VALUE);                   \
+            shmem_long_p(SCAN_READY(pSync, my_round), SHCOLL_SYNC_VALUE, me); \
+                                                                        \
+            shmem_getmem(tmp_array, dest, nbytes, peer);                \
+            shmem_long_p(SCAN_ACK(pSync, my_round), SHCOLL_SYNC_VALUE + 1, peer); \
+                                                                        \
+            local_##_name##_reduce(dest, tmp_array, dest, nreduce);     \
+        }                                                               \
+                                                                        \
+        /* dest is final now, pass it down to the right subtrees */     \
+        for (distance >>= 1, round = my_round - 1; round >= 0; distance >>= 1, round--) { \
+            if (me_scan + distance < scan_size) {                       \
+                shmem_long_p(SCAN_READY(pSync, round), SHCOLL_SYNC_VALUE + 1, \
+                             me + distance * stride);                   \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        for (distance = 1, round = 0; round < my_round; distance <<= 1, round++) { \
+            if (me_scan + distance < scan_size) {                       \
+                shmem_long_wait_until(SCAN_ACK(pSync, round), SHMEM_CMP_NE, \
+                                      SHCOLL_SYNC_VALUE);               \
+                shmem_long_p(SCAN_ACK(pSync, round), SHCOLL_SYNC_VALUE, me); \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        free(tmp_array);                                                \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_scan_up_down_sweep(_type *dest, const _type *source, \
+                                        int nreduce, int PE_start,      \
+                                        int logPE_stride, int PE_size,  \
+                                        _type *pWrk, long *pSync)       \
+    {                                                                   \
+        if (dest != source) {                                           \
+            memcpy(dest, source, sizeof(_type) * nreduce);              \
+        }                                                               \
+                                                                        \
+        scan_##_name##_helper_up_down_sweep(dest, nreduce, 0, PE_start, \
+                                            logPE_stride, PE_size, pSync); \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_##_name##_exscan_up_down_sweep(_type *dest, const _type *source, \
+                                          int nreduce, int PE_start,    \
+                                          int logPE_stride, int PE_size, \
+                                          _type *pWrk, long *pSync)     \
+    {                                                                   \
+        exscan_shift(dest, source, sizeof(_type) * nreduce, PE_start,   \
+                     logPE_stride, PE_size, pSync);                     \
+                                                                        \
+        scan_##_name##_helper_up_down_sweep(dest, nreduce, 1, PE_start, \
+                                            logPE_stride, PE_size, pSync); \
+    }
+
+
+/* @formatter:off */
+
+#ifndef CMAKE
+        SHCOLL_REDUCE_DEFINE(REDUCE_HELPER_LOCAL)
+        SHCOLL_REDUCE_DEFINE(SCAN_HELPER_REC_DBL)
+        SHCOLL_REDUCE_DEFINE(SCAN_HELPER_UP_DOWN_SWEEP)
+#else
+        REDUCE_HELPER_LOCAL(int_sum, int, SUM_OP)
+        SCAN_HELPER_REC_DBL(int_sum, int, SUM_OP)
+        SCAN_HELPER_UP_DOWN_SWEEP(int_sum, int, SUM_OP)
+#endif
+
+/* @formatter:on */
@@ -0,0 +1,235 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#include "shcoll.h"
+#include "shcoll/compat.h"
+#include "util/trees.h"
+#include "util/scan.h"
+
+#include <string.h>
+#include <limits.h>
+
+static int knomial_tree_radix_scatter = 2;
+
+void
+shcoll_set_scatter_knomial_tree_radix(int tree_radix)
+{
+    knomial_tree_radix_scatter = tree_radix;
+}
+
+/*
+ * The helpers get the position of the block of the current PE in source and
+ * the size of source, the scatter variants compute them from nbytes and the
+ * scatterv variants with exclusive_prefix_sum.
+ *
+ * pSync[0..4) are used by the helpers
+ * pSync[4..4+PREFIX_SUM_SYNC_SIZE) is used for exclusive prefix sum
+ *
+ * In the linear scatter a PE gets its block as soon as the root is done with
+ * the prefix sum, while other PEs may still be in it: the scatterv variants use
+ * the acked prefix sum, as gatherv does.
+ */
+
+inline static void
+scatter_helper_linear(void *dest, const void *source, size_t nbytes,
+                      size_t block_offset, size_t total_nbytes,
+                      int PE_root, int PE_start, int logPE_stride, int PE_size,
+                      long *pSync)
+{
+    /* pSync[0] counts the PEs that have read their block from the root
+     * pSync[1] is set by the root when its source can be read */
+
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+    const int me_as = (me - PE_start) / stride;
+    const int root = PE_start + PE_root * stride;
+    int i;
+
+    if (me_as == PE_root) {
+        for (i = 0; i < PE_size; i++) {
+            if (i != PE_root) {
+                shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE + 1, PE_start + i * stride);
+            }
+        }
+
+        memcpy(dest, (const char *) source + block_offset, nbytes);
+
+        shmem_long_wait_until(pSync, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + PE_size - 1);
+        shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
+    } else {
+        shmem_long_wait_until(pSync + 1, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        shmem_long_p(pSync + 1, SHCOLL_SYNC_VALUE, me);
+
+        shmem_getmem(dest, (const char *) source + block_offset, nbytes, root);
+        shmem_long_atomic_inc(pSync, root);
+    }
+}
+
+/*
+ * Tree scatter: the sizes of the subtrees are summed up the tree first, then
+ * every PE reads the blocks of its subtree from its parent into its own dest,
+ * starting with its own block, so dest must be large enough for the blocks
+ * of the subtree on all the PEs.  The children of the root read from source
+ * directly, where the blocks are in the PE order.
+ */
+inline static void
+scatter_helper_tree(void *dest, const void *source, size_t nbytes,
+                    size_t block_offset, size_t total_nbytes,
+                    int PE_root, int PE_start, int logPE_stride,
+                    int parent, const int *children, int children_num,
+                    long *pSync)
+{
+    /* pSync[0] receives the block offset of the parent when its data is ready
+     * pSync[1] sums the sizes of the subtrees of the children
+     * pSync[2] counts the children that have sent the size
+     * pSync[3] counts the children that have read their data */
+
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+
+    size_t *parent_offset = (size_t *) pSync;
+    size_t *children_nbytes = (size_t *) (pSync + 1);
+    long *children_sized = pSync + 2;
+    long *children_done = pSync + 3;
+
+    size_t subtree_nbytes = nbytes;
+    size_t offset;
+    int parent_pe;
+    int i;
+
+    if (children_num != 0) {
+        shmem_long_wait_until(children_sized, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + children_num);
+        subtree_nbytes += *children_nbytes - SHCOLL_SYNC_VALUE;
+
+        shmem_size_p(children_nbytes, SHCOLL_SYNC_VALUE, me);
+        shmem_long_p(children_sized, SHCOLL_SYNC_VALUE, me);
+    }
+
+    if (parent == -1) {
+        memcpy(dest, (const char *) source + block_offset, nbytes);
+    } else {
+        parent_pe = PE_start + parent * stride;
+
+        shmem_size_atomic_add(children_nbytes, subtree_nbytes, parent_pe);
+        shmem_fence();
+        shmem_long_atomic_inc(children_sized, parent_pe);
+
+        shmem_size_wait_until(parent_offset, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+        offset = *parent_offset - 1 - SHCOLL_SYNC_VALUE;
+        shmem_size_p(parent_offset, SHCOLL_SYNC_VALUE, me);
+
+        if (parent == PE_root) {
+            /* The subtree may wrap around the end of source */
+            offset = total_nbytes - block_offset < subtree_nbytes ? total_nbytes - block_offset : subtree_nbytes;
+
+            shmem_getmem_nbi(dest, (const char *) source + block_offset, offset, parent_pe);
+            shmem_getmem_nbi((char *) dest + offset, source, subtree_nbytes - offset, parent_pe);
+            shmem_quiet();
+        } else {
+            /* Position of my subtree in the dest of the parent */
+            offset = block_offset >= offset ? block_offset - offset : block_offset + total_nbytes - offset;
+
+            shmem_getmem(dest, (char *) dest + offset, subtree_nbytes, parent_pe);
+        }
+
+        shmem_long_atomic_inc(children_done, parent_pe);
+    }
+
+    if (children_num != 0) {
+        for (i = 0; i < children_num; i++) {
+            shmem_size_atomic_set(parent_offset, block_offset + 1 + SHCOLL_SYNC_VALUE,
+                                  PE_start + children[i] * stride);
+        }
+
+        shmem_long_wait_until(children_done, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + children_num);
+        shmem_long_p(children_done, SHCOLL_SYNC_VALUE, me);
+    }
+}
+
+inline static void
+scatter_helper_binomial_tree(void *dest, const void *source, size_t nbytes,
+                             size_t block_offset, size_t total_nbytes,
+                             int PE_root, int PE_start, int logPE_stride, int PE_size,
+                             long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me_as = (shmem_my_pe() - PE_start) / stride;
+    node_info_binomial_t node;
+
+    get_node_info_binomial_root(PE_size, PE_root, me_as, &node);
+
+    scatter_helper_tree(dest, source, nbytes, block_offset, total_nbytes, PE_root, PE_start, logPE_stride,
+                        node.parent, node.children, node.children_num, pSync);
+}
+
+inline static void
+scatter_helper_knomial_tree(void *dest, const void *source, size_t nbytes,
+                            size_t block_offset, size_t total_nbytes,
+                            int PE_root, int PE_start, int logPE_stride, int PE_size,
+                            long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me_as = (shmem_my_pe() - PE_start) / stride;
+    node_info_knomial_t node;
+
+    get_node_info_knomial_root(PE_size, PE_root, knomial_tree_radix_scatter, me_as, &node);
+
+    scatter_helper_tree(dest, source, nbytes, block_offset, total_nbytes, PE_root, PE_start, logPE_stride,
+                        node.parent, node.children, node.children_num, pSync);
+}
+
+#define SHCOLL_SCATTER_DEFINITION(_name, _size)                         \
+    void                                                                \
+    shcoll_scatter##_size##_##_name(void *dest, const void *source,     \
+                                    size_t nelems, int PE_root,         \
+                                    int PE_start, int logPE_stride,     \
+                                    int PE_size, long *pSync)           \
+    {                                                                   \
+        const size_t nbytes = (_size) / CHAR_BIT * nelems;              \
+        const int me_as = (shmem_my_pe() - PE_start) / (1 << logPE_stride); \
+                                                                        \
+        scatter_helper_##_name(dest, source, nbytes,                    \
+                               me_as * nbytes, PE_size * nbytes,        \
+                               PE_root, PE_start, logPE_stride, PE_size, \
+                               pSync);                                  \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shcoll_scatterv##_size##_##_name(void *dest, const void *source,    \
+                                     size_t nelems, int PE_root,        \
+                                     int PE_start, int logPE_stride,    \
+                                     int PE_size, long *pSync)          \
+    {                                                                   \
+        const size_t nbytes = (_size) / CHAR_BIT * nelems;              \
+        size_t block_offset;                                            \
+        size_t total_nbytes;                                            \
+                                                                        \
+        exclusive_prefix_sum_acked(&block_offset, &total_nbytes, nbytes, \
+                                   PE_start, logPE_stride, PE_size,     \
+                                   pSync + 4);                          \
+                                                                        \
+        scatter_helper_##_name(dest, source, nbytes,                    \
+                               block_offset, total_nbytes,              \
+                               PE_root, PE_start, logPE_stride, PE_size, \
+                               pSync);                                  \
+    }
+
+/* @formatter:off */
+
+SHCOLL_SCATTER_DEFINITION(linear, 8)
+SHCOLL_SCATTER_DEFINITION(linear, 16)
+SHCOLL_SCATTER_DEFINITION(linear, 32)
+SHCOLL_SCATTER_DEFINITION(linear, 64)
+
+SHCOLL_SCATTER_DEFINITION(binomial_tree, 8)
+SHCOLL_SCATTER_DEFINITION(binomial_tree, 16)
+SHCOLL_SCATTER_DEFINITION(binomial_tree, 32)
+SHCOLL_SCATTER_DEFINITION(binomial_tree, 64)
+
+SHCOLL_SCATTER_DEFINITION(knomial_tree, 8)
+SHCOLL_SCATTER_DEFINITION(knomial_tree, 16)
+SHCOLL_SCATTER_DEFINITION(knomial_tree, 32)
+SHCOLL_SCATTER_DEFINITION(knomial_tree, 64)
+
+/* @formatter:on */
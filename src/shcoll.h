@@ -16,6 +16,9 @@
 #include <shcoll/broadcast.h>
 #include <shcoll/collect.h>
 #include <shcoll/fcollect.h>
+#include <shcoll/gather.h>
 #include <shcoll/reduction.h>
+#include <shcoll/scan.h>
+#include <shcoll/scatter.h>
 
 #endif /* ! _SHCOLL_H */
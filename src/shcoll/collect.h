@@ -14,6 +14,12 @@
                                          int PE_size,           \
                                          long *pSync);
 
+/* Radix of the bruck_radix variants */
+void shcoll_set_collect_bruck_radix(int radix);
+
+/* Segment size in bytes of the ring_segmented variant */
+void shcoll_set_collect_ring_segment_size(size_t segment_size);
+
 SHCOLL_COLLECT_DECLARATION(linear, 32)
 SHCOLL_COLLECT_DECLARATION(linear, 64)
 
@@ -29,13 +35,61 @@ SHCOLL_COLLECT_DECLARATION(rec_dbl, 64)
 SHCOLL_COLLECT_DECLARATION(rec_dbl_signal, 32)
 SHCOLL_COLLECT_DECLARATION(rec_dbl_signal, 64)
 
+SHCOLL_COLLECT_DECLARATION(rec_dbl_fold, 32)
+SHCOLL_COLLECT_DECLARATION(rec_dbl_fold, 64)
+
+SHCOLL_COLLECT_DECLARATION(rec_dbl_no_scan, 32)
+SHCOLL_COLLECT_DECLARATION(rec_dbl_no_scan, 64)
+
 SHCOLL_COLLECT_DECLARATION(ring, 32)
 SHCOLL_COLLECT_DECLARATION(ring, 64)
 
+SHCOLL_COLLECT_DECLARATION(bidir_ring, 32)
+SHCOLL_COLLECT_DECLARATION(bidir_ring, 64)
+
+SHCOLL_COLLECT_DECLARATION(ring_segmented, 32)
+SHCOLL_COLLECT_DECLARATION(ring_segmented, 64)
+
+SHCOLL_COLLECT_DECLARATION(ring_no_scan, 32)
+SHCOLL_COLLECT_DECLARATION(ring_no_scan, 64)
+
 SHCOLL_COLLECT_DECLARATION(bruck, 32)
 SHCOLL_COLLECT_DECLARATION(bruck, 64)
 
 SHCOLL_COLLECT_DECLARATION(bruck_no_rotate, 32)
 SHCOLL_COLLECT_DECLARATION(bruck_no_rotate, 64)
 
+SHCOLL_COLLECT_DECLARATION(bruck_radix, 32)
+SHCOLL_COLLECT_DECLARATION(bruck_radix, 64)
+
+SHCOLL_COLLECT_DECLARATION(bruck_radix_no_rotate, 32)
+SHCOLL_COLLECT_DECLARATION(bruck_radix_no_rotate, 64)
+
+SHCOLL_COLLECT_DECLARATION(bruck_radix_inplace, 32)
+SHCOLL_COLLECT_DECLARATION(bruck_radix_inplace, 64)
+
+/*
+ * Planned collect for repeated calls with the same active set.  The plan
+ * caches the offset of the local block and the total size, they are
+ * computed again only if the size of a block has changed since the last
+ * call.  nbytes is the size of the local block in bytes, pSync must have
+ * SHCOLL_COLLECT_PLANNED_SYNC_SIZE elements.
+ */
+typedef struct shcoll_collect_plan shcoll_collect_plan_t;
+
+shcoll_collect_plan_t *shcoll_collect_plan_create(size_t nbytes, int PE_start,
+                                                  int logPE_stride, int PE_size,
+                                                  long *pSync);
+void shcoll_collect_plan_destroy(shcoll_collect_plan_t *plan);
+
+#define SHCOLL_COLLECT_PLANNED_DECLARATION(_size)                       \
+    void shcoll_collect##_size##_planned(shcoll_collect_plan_t *plan,   \
+                                         void *dest,                    \
+                                         const void *source,            \
+                                         size_t nelems,                 \
+                                         long *pSync);
+
+SHCOLL_COLLECT_PLANNED_DECLARATION(32)
+SHCOLL_COLLECT_PLANNED_DECLARATION(64)
+
 #endif /* ! _SHCOLL_COLLECT_H */
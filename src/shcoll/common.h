@@ -6,6 +6,7 @@
 #define _SHCOLL_COMMON_H 1
 
 #include <stddef.h>             /* ptrdiff_t */
+#include <stdint.h>             /* uint16_t */
 
 #define SHCOLL_BCAST_SYNC_SIZE 2
 
@@ -13,12 +14,48 @@
 
 #define PE_SIZE_LOG 32
 
+/* An ack counter and a prefix and a suffix slot per round */
+#define PREFIX_SUM_SYNC_SIZE (1 + PE_SIZE_LOG * 2)
+
 /* TODO chose correct values */
 #define SHCOLL_ALLTOALL_SYNC_SIZE 64
 #define SHCOLL_ALLTOALLS_SYNC_SIZE SHMEM_ALLTOALLS_SYNC_SIZE
 #define SHCOLL_BARRIER_SYNC_SIZE SHMEM_BARRIER_SYNC_SIZE
-#define SHCOLL_COLLECT_SYNC_SIZE 68
+#define SHCOLL_COLLECT_SYNC_SIZE (PREFIX_SUM_SYNC_SIZE + PE_SIZE_LOG + 4)
+#define SHCOLL_COLLECT_PLANNED_SYNC_SIZE (SHCOLL_COLLECT_SYNC_SIZE + PE_SIZE_LOG)
+#define SHCOLL_GATHER_SYNC_SIZE (PREFIX_SUM_SYNC_SIZE + 4)
 #define SHCOLL_REDUCE_SYNC_SIZE (PE_SIZE_LOG * 2)
 #define SHCOLL_REDUCE_MIN_WRKDATA_SIZE SHMEM_REDUCE_MIN_WRKDATA_SIZE
+#define SHCOLL_REDUCE_HIERARCHICAL_SYNC_SIZE (SHCOLL_REDUCE_SYNC_SIZE + PE_SIZE_LOG * 2)
+#define SHCOLL_REDUCE_SPARSE_SYNC_SIZE (SHCOLL_REDUCE_SYNC_SIZE + PE_SIZE_LOG * 2 + 2)
+#define SHCOLL_REDUCE_SPARSE_WRKDATA_SIZE(_type, _max_nnz) \
+    (((_max_nnz) * (sizeof(_type) + sizeof(int)) + 2 * sizeof(long) + sizeof(_type) - 1) / sizeof(_type))
+#define SHCOLL_SCAN_SYNC_SIZE (PE_SIZE_LOG * 2)
+#define SHCOLL_SCATTER_SYNC_SIZE (PREFIX_SUM_SYNC_SIZE + 4)
+
+/* IEEE 754 half precision and bfloat16 values, stored as raw bits */
+typedef uint16_t shcoll_fp16_t;
+typedef uint16_t shcoll_bf16_t;
+
+/* Value and index pairs for MAXLOC and MINLOC reductions */
+typedef struct {
+    double val;
+    int loc;
+} shcoll_double_int_t;
+
+typedef struct {
+    float val;
+    int loc;
+} shcoll_float_int_t;
+
+typedef struct {
+    long val;
+    int loc;
+} shcoll_long_int_t;
+
+typedef struct {
+    int val;
+    int loc;
+} shcoll_int_int_t;
 
 #endif /* ! _SHCOLL_COMMON_H */
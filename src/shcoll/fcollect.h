@@ -14,6 +14,12 @@
                                           int PE_size,          \
                                           long *pSync);
 
+/* Radix of the bruck_radix variants */
+void shcoll_set_fcollect_bruck_radix(int radix);
+
+/* Segment size in bytes of the ring_segmented variant */
+void shcoll_set_fcollect_ring_segment_size(size_t segment_size);
+
 SHCOLL_FCOLLECT_DECLARATION(linear, 32)
 SHCOLL_FCOLLECT_DECLARATION(linear, 64)
 
@@ -26,9 +32,18 @@ SHCOLL_FCOLLECT_DECLARATION(all_linear1, 64)
 SHCOLL_FCOLLECT_DECLARATION(rec_dbl, 32)
 SHCOLL_FCOLLECT_DECLARATION(rec_dbl, 64)
 
+SHCOLL_FCOLLECT_DECLARATION(rec_dbl_fold, 32)
+SHCOLL_FCOLLECT_DECLARATION(rec_dbl_fold, 64)
+
 SHCOLL_FCOLLECT_DECLARATION(ring, 32)
 SHCOLL_FCOLLECT_DECLARATION(ring, 64)
 
+SHCOLL_FCOLLECT_DECLARATION(bidir_ring, 32)
+SHCOLL_FCOLLECT_DECLARATION(bidir_ring, 64)
+
+SHCOLL_FCOLLECT_DECLARATION(ring_segmented, 32)
+SHCOLL_FCOLLECT_DECLARATION(ring_segmented, 64)
+
 SHCOLL_FCOLLECT_DECLARATION(bruck, 32)
 SHCOLL_FCOLLECT_DECLARATION(bruck, 64)
 
@@ -41,6 +56,15 @@ SHCOLL_FCOLLECT_DECLARATION(bruck_signal, 64)
 SHCOLL_FCOLLECT_DECLARATION(bruck_inplace, 32)
 SHCOLL_FCOLLECT_DECLARATION(bruck_inplace, 64)
 
+SHCOLL_FCOLLECT_DECLARATION(bruck_radix, 32)
+SHCOLL_FCOLLECT_DECLARATION(bruck_radix, 64)
+
+SHCOLL_FCOLLECT_DECLARATION(bruck_radix_no_rotate, 32)
+SHCOLL_FCOLLECT_DECLARATION(bruck_radix_no_rotate, 64)
+
+SHCOLL_FCOLLECT_DECLARATION(bruck_radix_inplace, 32)
+SHCOLL_FCOLLECT_DECLARATION(bruck_radix_inplace, 64)
+
 SHCOLL_FCOLLECT_DECLARATION(neighbor_exchange, 32)
 SHCOLL_FCOLLECT_DECLARATION(neighbor_exchange, 64)
 
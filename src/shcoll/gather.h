@@ -0,0 +1,43 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#ifndef _SHCOLL_GATHER_H
+#define _SHCOLL_GATHER_H 1
+
+void shcoll_set_gather_knomial_tree_radix(int tree_radix);
+
+#define SHCOLL_GATHER_DECLARATION(_name, _size)                 \
+    void shcoll_gather##_size##_##_name(void *dest,             \
+                                        const void *source,     \
+                                        size_t nelems,          \
+                                        int PE_root,            \
+                                        int PE_start,           \
+                                        int logPE_stride,       \
+                                        int PE_size,            \
+                                        long *pSync);           \
+    void shcoll_gatherv##_size##_##_name(void *dest,            \
+                                         const void *source,    \
+                                         size_t nelems,         \
+                                         int PE_root,           \
+                                         int PE_start,          \
+                                         int logPE_stride,      \
+                                         int PE_size,           \
+                                         long *pSync);
+
+SHCOLL_GATHER_DECLARATION(linear, 8)
+SHCOLL_GATHER_DECLARATION(linear, 16)
+SHCOLL_GATHER_DECLARATION(linear, 32)
+SHCOLL_GATHER_DECLARATION(linear, 64)
+
+SHCOLL_GATHER_DECLARATION(binomial_tree, 8)
+SHCOLL_GATHER_DECLARATION(binomial_tree, 16)
+SHCOLL_GATHER_DECLARATION(binomial_tree, 32)
+SHCOLL_GATHER_DECLARATION(binomial_tree, 64)
+
+SHCOLL_GATHER_DECLARATION(knomial_tree, 8)
+SHCOLL_GATHER_DECLARATION(knomial_tree, 16)
+SHCOLL_GATHER_DECLARATION(knomial_tree, 32)
+SHCOLL_GATHER_DECLARATION(knomial_tree, 64)
+
+#endif /* ! _SHCOLL_GATHER_H */
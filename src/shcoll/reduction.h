@@ -5,6 +5,31 @@
 #ifndef _SHCOLL_REDUCTION_H
 #define _SHCOLL_REDUCTION_H 1
 
+/*
+ * User-defined reduction operator: dest[i] = src1[i] op src2[i] for nelems
+ * elements.  dest may be the same buffer as src1 or src2.
+ */
+typedef void (*shcoll_reduce_op_t)(void *dest, const void *src1,
+                                   const void *src2, size_t nelems);
+
+#define SHCOLL_REDUCE_USER_DECLARE(_algorithm)                          \
+    void shcoll_reduce_user_to_all_##_algorithm(void *dest,             \
+                                                const void *source,     \
+                                                int nreduce,            \
+                                                size_t elem_size,       \
+                                                shcoll_reduce_op_t op,  \
+                                                int PE_start,           \
+                                                int logPE_stride,       \
+                                                int PE_size,            \
+                                                void *pWrk,             \
+                                                long *pSync)
+
+#define SHCOLL_REDUCE_USER_SIZE_DECLARE(_algorithm)                     \
+    void shcoll_reduce_user_to_all_##_algorithm##_size(void *dest,      \
+            const void *source, size_t nreduce, size_t elem_size,       \
+            shcoll_reduce_op_t op, int PE_start, int logPE_stride,      \
+            int PE_size, void *pWrk, long *pSync)
+
 #define SHCOLL_REDUCE_DECLARE(_name, _type, _algorithm)             \
     void shcoll_##_name##_to_all_##_algorithm(_type *dest,          \
                                               const _type *source,  \
@@ -15,69 +40,285 @@
                                               _type *pWrk,          \
                                               long *pSync)
 
-#define SHCOLL_REDUCE_DECLARE_ALL(_algorithm)                           \
+#define SHCOLL_REDUCE_SIZE_DECLARE(_name, _type, _algorithm)        \
+    void shcoll_##_name##_to_all_##_algorithm##_size(_type *dest,   \
+            const _type *source, size_t nreduce, int PE_start,      \
+            int logPE_stride, int PE_size, _type *pWrk, long *pSync)
+
+#define SHCOLL_ROOTED_REDUCE_DECLARE(_name, _type, _algorithm)      \
+    void shcoll_##_name##_reduce_##_algorithm(_type *dest,          \
+                                              const _type *source,  \
+                                              int nreduce,          \
+                                              int PE_root,          \
+                                              int PE_start,         \
+                                              int logPE_stride,     \
+                                              int PE_size,          \
+                                              _type *pWrk,          \
+                                              long *pSync)
+
+#define SHCOLL_REDUCE_FOR_ALL_TYPES(_declare, _algorithm)               \
     /* AND operation */                                                 \
-    SHCOLL_REDUCE_DECLARE(short_and,        short,      _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(int_and,          int,        _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(long_and,         long,       _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(longlong_and,     long long,  _algorithm);    \
+    _declare(short_and,        short,              _algorithm);         \
+    _declare(int_and,          int,                _algorithm);         \
+    _declare(long_and,         long,               _algorithm);         \
+    _declare(longlong_and,     long long,          _algorithm);         \
                                                                         \
     /* MAX operation */                                                 \
-    SHCOLL_REDUCE_DECLARE(short_max,        short,          _algorithm); \
-    SHCOLL_REDUCE_DECLARE(int_max,          int,            _algorithm); \
-    SHCOLL_REDUCE_DECLARE(double_max,       double,         _algorithm); \
-    SHCOLL_REDUCE_DECLARE(float_max,        float,          _algorithm); \
-    SHCOLL_REDUCE_DECLARE(long_max,         long,           _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longdouble_max,   long double,    _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longlong_max,     long long,      _algorithm); \
+    _declare(short_max,        short,              _algorithm);         \
+    _declare(int_max,          int,                _algorithm);         \
+    _declare(double_max,       double,             _algorithm);         \
+    _declare(float_max,        float,              _algorithm);         \
+    _declare(long_max,         long,               _algorithm);         \
+    _declare(longdouble_max,   long double,        _algorithm);         \
+    _declare(longlong_max,     long long,          _algorithm);         \
+    _declare(fp16_max,         shcoll_fp16_t,      _algorithm);         \
+    _declare(bf16_max,         shcoll_bf16_t,      _algorithm);         \
                                                                         \
     /* MIN operation */                                                 \
-    SHCOLL_REDUCE_DECLARE(short_min,        short,          _algorithm); \
-    SHCOLL_REDUCE_DECLARE(int_min,          int,            _algorithm); \
-    SHCOLL_REDUCE_DECLARE(double_min,       double,         _algorithm); \
-    SHCOLL_REDUCE_DECLARE(float_min,        float,          _algorithm); \
-    SHCOLL_REDUCE_DECLARE(long_min,         long,           _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longdouble_min,   long double,    _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longlong_min,     long long,      _algorithm); \
+    _declare(short_min,        short,              _algorithm);         \
+    _declare(int_min,          int,                _algorithm);         \
+    _declare(double_min,       double,             _algorithm);         \
+    _declare(float_min,        float,              _algorithm);         \
+    _declare(long_min,         long,               _algorithm);         \
+    _declare(longdouble_min,   long double,        _algorithm);         \
+    _declare(longlong_min,     long long,          _algorithm);         \
+    _declare(fp16_min,         shcoll_fp16_t,      _algorithm);         \
+    _declare(bf16_min,         shcoll_bf16_t,      _algorithm);         \
                                                                         \
     /* SUM operation */                                                 \
-    SHCOLL_REDUCE_DECLARE(complexd_sum,     double _Complex,    _algorithm); \
-    SHCOLL_REDUCE_DECLARE(complexf_sum,     float _Complex,     _algorithm); \
-    SHCOLL_REDUCE_DECLARE(short_sum,        short,              _algorithm); \
-    SHCOLL_REDUCE_DECLARE(int_sum,          int,                _algorithm); \
-    SHCOLL_REDUCE_DECLARE(double_sum,       double,             _algorithm); \
-    SHCOLL_REDUCE_DECLARE(float_sum,        float,              _algorithm); \
-    SHCOLL_REDUCE_DECLARE(long_sum,         long,               _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longdouble_sum,   long double,        _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longlong_sum,     long long,          _algorithm); \
+    _declare(complexd_sum,     double _Complex,    _algorithm);         \
+    _declare(complexf_sum,     float _Complex,     _algorithm);         \
+    _declare(short_sum,        short,              _algorithm);         \
+    _declare(int_sum,          int,                _algorithm);         \
+    _declare(double_sum,       double,             _algorithm);         \
+    _declare(float_sum,        float,              _algorithm);         \
+    _declare(long_sum,         long,               _algorithm);         \
+    _declare(longdouble_sum,   long double,        _algorithm);         \
+    _declare(longlong_sum,     long long,          _algorithm);         \
+    _declare(fp16_sum,         shcoll_fp16_t,      _algorithm);         \
+    _declare(bf16_sum,         shcoll_bf16_t,      _algorithm);         \
                                                                         \
     /* PROD operation */                                                \
-    SHCOLL_REDUCE_DECLARE(complexd_prod,    double _Complex,    _algorithm); \
-    SHCOLL_REDUCE_DECLARE(complexf_prod,    float _Complex,     _algorithm); \
-    SHCOLL_REDUCE_DECLARE(short_prod,       short,              _algorithm); \
-    SHCOLL_REDUCE_DECLARE(int_prod,         int,                _algorithm); \
-    SHCOLL_REDUCE_DECLARE(double_prod,      double,             _algorithm); \
-    SHCOLL_REDUCE_DECLARE(float_prod,       float,              _algorithm); \
-    SHCOLL_REDUCE_DECLARE(long_prod,        long,               _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longdouble_prod,  long double,        _algorithm); \
-    SHCOLL_REDUCE_DECLARE(longlong_prod,    long long,          _algorithm); \
+    _declare(complexd_prod,    double _Complex,    _algorithm);         \
+    _declare(complexf_prod,    float _Complex,     _algorithm);         \
+    _declare(short_prod,       short,              _algorithm);         \
+    _declare(int_prod,         int,                _algorithm);         \
+    _declare(double_prod,      double,             _algorithm);         \
+    _declare(float_prod,       float,              _algorithm);         \
+    _declare(long_prod,        long,               _algorithm);         \
+    _declare(longdouble_prod,  long double,        _algorithm);         \
+    _declare(longlong_prod,    long long,          _algorithm);         \
                                                                         \
     /* OR operation */                                                  \
-    SHCOLL_REDUCE_DECLARE(short_or,         short,      _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(int_or,           int,        _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(long_or,          long,       _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(longlong_or,      long long,  _algorithm);    \
+    _declare(short_or,         short,              _algorithm);         \
+    _declare(int_or,           int,                _algorithm);         \
+    _declare(long_or,          long,               _algorithm);         \
+    _declare(longlong_or,      long long,          _algorithm);         \
                                                                         \
     /* XOR operation */                                                 \
-    SHCOLL_REDUCE_DECLARE(short_xor,        short,      _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(int_xor,          int,        _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(long_xor,         long,       _algorithm);    \
-    SHCOLL_REDUCE_DECLARE(longlong_xor,     long long,  _algorithm);
+    _declare(short_xor,        short,              _algorithm);         \
+    _declare(int_xor,          int,                _algorithm);         \
+    _declare(long_xor,         long,               _algorithm);         \
+    _declare(longlong_xor,     long long,          _algorithm);         \
+                                                                        \
+    /* MAXLOC operation */                                              \
+    _declare(double_maxloc,    shcoll_double_int_t, _algorithm);        \
+    _declare(float_maxloc,     shcoll_float_int_t, _algorithm);         \
+    _declare(long_maxloc,      shcoll_long_int_t,  _algorithm);         \
+    _declare(int_maxloc,       shcoll_int_int_t,   _algorithm);         \
+                                                                        \
+    /* MINLOC operation */                                              \
+    _declare(double_minloc,    shcoll_double_int_t, _algorithm);        \
+    _declare(float_minloc,     shcoll_float_int_t, _algorithm);         \
+    _declare(long_minloc,      shcoll_long_int_t,  _algorithm);         \
+    _declare(int_minloc,       shcoll_int_int_t,   _algorithm);
+
+/* Integer types and operations supported by the atomic-based algorithm */
+#define SHCOLL_REDUCE_ATOMIC_DECLARE_ALL(_algorithm)                    \
+    SHCOLL_REDUCE_DECLARE(short_and,   short,  _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(int_and,     int,    _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(long_and,    long,   _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(short_max,   short,  _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(int_max,     int,    _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(long_max,    long,   _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(short_min,   short,  _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(int_min,     int,    _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(long_min,    long,   _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(short_sum,   short,  _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(int_sum,     int,    _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(long_sum,    long,   _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(short_or,    short,  _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(int_or,      int,    _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(long_or,     long,   _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(short_xor,   short,  _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(int_xor,     int,    _algorithm);             \
+    SHCOLL_REDUCE_DECLARE(long_xor,    long,   _algorithm);
+
+#define SHCOLL_REDUCE_DECLARE_ALL(_algorithm)                           \
+    SHCOLL_REDUCE_FOR_ALL_TYPES(SHCOLL_REDUCE_DECLARE, _algorithm)
+
+#define SHCOLL_REDUCE_SIZE_DECLARE_ALL(_algorithm)                      \
+    SHCOLL_REDUCE_FOR_ALL_TYPES(SHCOLL_REDUCE_SIZE_DECLARE, _algorithm)
+
+#define SHCOLL_ROOTED_REDUCE_DECLARE_ALL(_algorithm)                    \
+    SHCOLL_REDUCE_FOR_ALL_TYPES(SHCOLL_ROOTED_REDUCE_DECLARE, _algorithm)
 
+void shcoll_set_reduce_knomial_tree_radix(int tree_radix);
+void shcoll_set_reduce_segment_size(size_t segment_size);
+void shcoll_set_reduce_rec_mult_radix(int radix);
+void shcoll_set_reduce_rabenseifner_threshold(size_t threshold);
+void shcoll_set_reduce_sparse_density(double density);
+void shcoll_set_reduce_node_size(int node_size);
+void shcoll_set_reduce_threads(int nthreads);
+
+/* dest may be the same as source, linear, rec_dbl and rabenseifner then
+ * reduce in place without copying the vector */
 SHCOLL_REDUCE_DECLARE_ALL(linear)
 SHCOLL_REDUCE_DECLARE_ALL(binomial)
+SHCOLL_REDUCE_DECLARE_ALL(knomial)
+SHCOLL_REDUCE_DECLARE_ALL(binomial_pipelined)
+SHCOLL_REDUCE_DECLARE_ALL(knomial_pipelined)
 SHCOLL_REDUCE_DECLARE_ALL(rec_dbl)
+SHCOLL_REDUCE_DECLARE_ALL(rec_mult)
 SHCOLL_REDUCE_DECLARE_ALL(rabenseifner)
 SHCOLL_REDUCE_DECLARE_ALL(rabenseifner2)
 
+/* pWrk must hold nreduce elements, pSync SHCOLL_REDUCE_HIERARCHICAL_SYNC_SIZE */
+SHCOLL_REDUCE_DECLARE_ALL(hierarchical)
+
+/* Same as above, for more than INT_MAX elements */
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(linear)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(binomial)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(knomial)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(binomial_pipelined)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(knomial_pipelined)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(rec_dbl)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(rec_mult)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(rabenseifner)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(rabenseifner2)
+SHCOLL_REDUCE_SIZE_DECLARE_ALL(hierarchical)
+
+/*
+ * Reductions of elements of elem_size bytes with a user-defined operator.
+ * Built-in types and operators above go through the same engines with the
+ * operator inlined into a vectorizable loop.
+ */
+SHCOLL_REDUCE_USER_DECLARE(binomial);
+SHCOLL_REDUCE_USER_DECLARE(rec_dbl);
+SHCOLL_REDUCE_USER_DECLARE(rabenseifner);
+
+SHCOLL_REDUCE_USER_SIZE_DECLARE(binomial);
+SHCOLL_REDUCE_USER_SIZE_DECLARE(rec_dbl);
+SHCOLL_REDUCE_USER_SIZE_DECLARE(rabenseifner);
+
+/*
+ * Sparse reductions of vectors given as nnz (index, value) pairs.  The
+ * pairs variant returns the number of pairs of the result, sorted by index
+ * in dest_indices and dest_values.  max_nnz must bound the number of distinct
+ * indices over all the PEs, dest_indices and dest_values must hold max_nnz
+ * pairs.  The dense variant writes an nreduce element vector instead, the
+ * pairs are merged unless the total number of nonzeros reaches the density
+ * threshold (a fraction of nreduce) or max_nnz.  For both, pWrk must hold
+ * SHCOLL_REDUCE_SPARSE_WRKDATA_SIZE(_type, max_nnz) elements and pSync
+ * SHCOLL_REDUCE_SPARSE_SYNC_SIZE.
+ */
+#define SHCOLL_REDUCE_SPARSE_DECLARE(_name, _type)                      \
+    int shcoll_##_name##_to_all_sparse_pairs(int *dest_indices,         \
+                                             _type *dest_values,        \
+                                             const int *indices,        \
+                                             const _type *values,       \
+                                             int nnz, int max_nnz,      \
+                                             int PE_start, int logPE_stride, \
+                                             int PE_size, _type *pWrk,  \
+                                             long *pSync);              \
+                                                                        \
+    void shcoll_##_name##_to_all_sparse(_type *dest, const int *indices, \
+                                        const _type *values, int nnz,   \
+                                        int nreduce, int max_nnz,       \
+                                        int PE_start, int logPE_stride, \
+                                        int PE_size, _type *pWrk,       \
+                                        long *pSync)
+
+SHCOLL_REDUCE_SPARSE_DECLARE(float_sum, float);
+SHCOLL_REDUCE_SPARSE_DECLARE(double_sum, double);
+
+/*
+ * Batched reductions: small reductions of any type and operator are packed
+ * into one buffer and reduced with a single recursive doubling exchange.
+ * create and destroy are collective, max_bytes bounds the packed size
+ * (every added vector is padded to 16 bytes).  Results are copied to the
+ * dest buffers by shcoll_reduce_batch_end; source and dest do not need to
+ * be symmetric.
+ */
+typedef struct shcoll_reduce_batch shcoll_reduce_batch_t;
+
+shcoll_reduce_batch_t *shcoll_reduce_batch_create(size_t max_bytes);
+void shcoll_reduce_batch_destroy(shcoll_reduce_batch_t *batch);
+void shcoll_reduce_batch_begin(shcoll_reduce_batch_t *batch);
+void shcoll_reduce_batch_add(shcoll_reduce_batch_t *batch, void *dest,
+                             const void *source, int nreduce,
+                             size_t elem_size, shcoll_reduce_op_t op);
+void shcoll_reduce_batch_end(shcoll_reduce_batch_t *batch, int PE_start,
+                             int logPE_stride, int PE_size, long *pSync);
+
+#define SHCOLL_REDUCE_BATCH_ADD_DECLARE(_name, _type, _algorithm)       \
+    void shcoll_reduce_batch_add_##_name(shcoll_reduce_batch_t *batch,  \
+                                         _type *dest,                   \
+                                         const _type *source,           \
+                                         int nreduce)
+
+SHCOLL_REDUCE_FOR_ALL_TYPES(SHCOLL_REDUCE_BATCH_ADD_DECLARE, batch)
+
+/*
+ * Reduced precision wire format, accumulation is done in full precision.
+ * The rabenseifner2 variants do the allgather on a ring.
+ */
+SHCOLL_REDUCE_DECLARE(float_sum, float, rabenseifner_fp16);
+SHCOLL_REDUCE_DECLARE(float_sum, float, rabenseifner_bf16);
+SHCOLL_REDUCE_DECLARE(double_sum, double, rabenseifner_fp32);
+SHCOLL_REDUCE_DECLARE(double_sum, double, rabenseifner_fp16);
+SHCOLL_REDUCE_DECLARE(double_sum, double, rabenseifner_bf16);
+SHCOLL_REDUCE_DECLARE(float_sum, float, rabenseifner2_fp16);
+SHCOLL_REDUCE_DECLARE(float_sum, float, rabenseifner2_bf16);
+SHCOLL_REDUCE_DECLARE(double_sum, double, rabenseifner2_fp32);
+SHCOLL_REDUCE_DECLARE(double_sum, double, rabenseifner2_fp16);
+SHCOLL_REDUCE_DECLARE(double_sum, double, rabenseifner2_bf16);
+
+SHCOLL_REDUCE_SIZE_DECLARE(float_sum, float, rabenseifner_fp16);
+SHCOLL_REDUCE_SIZE_DECLARE(float_sum, float, rabenseifner_bf16);
+SHCOLL_REDUCE_SIZE_DECLARE(double_sum, double, rabenseifner_fp32);
+SHCOLL_REDUCE_SIZE_DECLARE(double_sum, double, rabenseifner_fp16);
+SHCOLL_REDUCE_SIZE_DECLARE(double_sum, double, rabenseifner_bf16);
+SHCOLL_REDUCE_SIZE_DECLARE(float_sum, float, rabenseifner2_fp16);
+SHCOLL_REDUCE_SIZE_DECLARE(float_sum, float, rabenseifner2_bf16);
+SHCOLL_REDUCE_SIZE_DECLARE(double_sum, double, rabenseifner2_fp32);
+SHCOLL_REDUCE_SIZE_DECLARE(double_sum, double, rabenseifner2_fp16);
+SHCOLL_REDUCE_SIZE_DECLARE(double_sum, double, rabenseifner2_bf16);
+
+/*
+ * MAXLOC and MINLOC in a single reduction: rec_dbl below the threshold
+ * (in bytes), rabenseifner above it
+ */
+#define SHCOLL_REDUCE_LOC_DECLARE(_name, _type)                         \
+    void shcoll_##_name##_to_all(_type *dest, const _type *source,      \
+                                 int nreduce, int PE_start,             \
+                                 int logPE_stride, int PE_size,         \
+                                 _type *pWrk, long *pSync)
+
+SHCOLL_REDUCE_LOC_DECLARE(double_maxloc, shcoll_double_int_t);
+SHCOLL_REDUCE_LOC_DECLARE(float_maxloc, shcoll_float_int_t);
+SHCOLL_REDUCE_LOC_DECLARE(long_maxloc, shcoll_long_int_t);
+SHCOLL_REDUCE_LOC_DECLARE(int_maxloc, shcoll_int_int_t);
+SHCOLL_REDUCE_LOC_DECLARE(double_minloc, shcoll_double_int_t);
+SHCOLL_REDUCE_LOC_DECLARE(float_minloc, shcoll_float_int_t);
+SHCOLL_REDUCE_LOC_DECLARE(long_minloc, shcoll_long_int_t);
+SHCOLL_REDUCE_LOC_DECLARE(int_minloc, shcoll_int_int_t);
+
+/* Falls back to rec_dbl for more than 4 elements */
+SHCOLL_REDUCE_ATOMIC_DECLARE_ALL(atomic)
+
+SHCOLL_ROOTED_REDUCE_DECLARE_ALL(binomial)
+SHCOLL_ROOTED_REDUCE_DECLARE_ALL(knomial)
+SHCOLL_ROOTED_REDUCE_DECLARE_ALL(rabenseifner)
+
 #endif /* ! _SHCOLL_REDUCTION_H */
@@ -0,0 +1,43 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#ifndef _SHCOLL_SCAN_H
+#define _SHCOLL_SCAN_H 1
+
+#include "reduction.h"          /* SHCOLL_REDUCE_FOR_ALL_TYPES */
+
+#define SHCOLL_SCAN_DECLARE(_name, _type, _algorithm)               \
+    void shcoll_##_name##_scan_##_algorithm(_type *dest,            \
+                                            const _type *source,    \
+                                            int nreduce,            \
+                                            int PE_start,           \
+                                            int logPE_stride,       \
+                                            int PE_size,            \
+                                            _type *pWrk,            \
+                                            long *pSync)
+
+#define SHCOLL_EXSCAN_DECLARE(_name, _type, _algorithm)             \
+    void shcoll_##_name##_exscan_##_algorithm(_type *dest,          \
+                                              const _type *source,  \
+                                              int nreduce,          \
+                                              int PE_start,         \
+                                              int logPE_stride,     \
+                                              int PE_size,          \
+                                              _type *pWrk,          \
+                                              long *pSync)
+
+#define SHCOLL_SCAN_DECLARE_ALL(_algorithm)                             \
+    SHCOLL_REDUCE_FOR_ALL_TYPES(SHCOLL_SCAN_DECLARE, _algorithm)        \
+    SHCOLL_REDUCE_FOR_ALL_TYPES(SHCOLL_EXSCAN_DECLARE, _algorithm)
+
+/*
+ * Inclusive (scan) and exclusive (exscan) prefix reductions over the
+ * active set, ordered by PE number.  The result of exscan on the first
+ * PE of the active set is undefined; its dest is not modified.
+ */
+
+SHCOLL_SCAN_DECLARE_ALL(rec_dbl)
+SHCOLL_SCAN_DECLARE_ALL(up_down_sweep)
+
+#endif /* ! _SHCOLL_SCAN_H */
@@ -0,0 +1,43 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#ifndef _SHCOLL_SCATTER_H
+#define _SHCOLL_SCATTER_H 1
+
+void shcoll_set_scatter_knomial_tree_radix(int tree_radix);
+
+#define SHCOLL_SCATTER_DECLARATION(_name, _size)                \
+    void shcoll_scatter##_size##_##_name(void *dest,            \
+                                         const void *source,    \
+                                         size_t nelems,         \
+                                         int PE_root,           \
+                                         int PE_start,          \
+                                         int logPE_stride,      \
+                                         int PE_size,           \
+                                         long *pSync);          \
+    void shcoll_scatterv##_size##_##_name(void *dest,           \
+                                          const void *source,   \
+                                          size_t nelems,        \
+                                          int PE_root,          \
+                                          int PE_start,         \
+                                          int logPE_stride,     \
+                                          int PE_size,          \
+                                          long *pSync);
+
+SHCOLL_SCATTER_DECLARATION(linear, 8)
+SHCOLL_SCATTER_DECLARATION(linear, 16)
+SHCOLL_SCATTER_DECLARATION(linear, 32)
+SHCOLL_SCATTER_DECLARATION(linear, 64)
+
+SHCOLL_SCATTER_DECLARATION(binomial_tree, 8)
+SHCOLL_SCATTER_DECLARATION(binomial_tree, 16)
+SHCOLL_SCATTER_DECLARATION(binomial_tree, 32)
+SHCOLL_SCATTER_DECLARATION(binomial_tree, 64)
+
+SHCOLL_SCATTER_DECLARATION(knomial_tree, 8)
+SHCOLL_SCATTER_DECLARATION(knomial_tree, 16)
+SHCOLL_SCATTER_DECLARATION(knomial_tree, 32)
+SHCOLL_SCATTER_DECLARATION(knomial_tree, 64)
+
+#endif /* ! _SHCOLL_SCATTER_H */
@@ -0,0 +1,108 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#ifndef OPENSHMEM_COLLECTIVE_ROUTINES_HALF_H
+#define OPENSHMEM_COLLECTIVE_ROUTINES_HALF_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Conversions between float and the 16-bit formats (IEEE 754 half precision
+ * and bfloat16).  Narrowing conversions round to nearest even.  Every case is
+ * computed and the result is selected, without branches, so that the
+ * conversion loops can be vectorized.
+ */
+
+inline static uint32_t
+float_as_bits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline static float
+bits_as_float(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/* Returns a if cond holds and b otherwise, with masks instead of a branch */
+inline static uint32_t
+half_select(int cond, uint32_t a, uint32_t b)
+{
+    uint32_t mask = -(uint32_t) (cond != 0);
+    return (a & mask) | (b & ~mask);
+}
+
+inline static float
+fp16_to_float(uint16_t h)
+{
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t bits = ((uint32_t) h & 0x7fffu) << 13;
+    uint32_t exp = bits & shifted_exp;
+    uint32_t inf_nan;
+    uint32_t denormal;
+
+    /* Rebias the exponent */
+    bits += (127 - 15) << 23;
+
+    /* Inf/NaN, and zero/denormal renormalized */
+    inf_nan = bits + ((128 - 16) << 23);
+    denormal = float_as_bits(bits_as_float(bits + (1 << 23)) - bits_as_float(113u << 23));
+
+    bits = half_select(exp == shifted_exp, inf_nan, half_select(exp == 0, denormal, bits));
+
+    return bits_as_float(bits | ((uint32_t) h & 0x8000u) << 16);
+}
+
+inline static uint16_t
+float_to_fp16(float f)
+{
+    const uint32_t f32_infinity = 255u << 23;
+    const uint32_t f16_max = (127u + 16) << 23;
+    const uint32_t denorm_magic = ((127u - 15) + (23 - 10) + 1) << 23;
+    uint32_t bits = float_as_bits(f);
+    uint32_t sign = bits & 0x80000000u;
+    uint32_t overflow;
+    uint32_t denormal;
+    uint32_t normal;
+
+    bits ^= sign;
+
+    /* Overflow to Inf, keep NaN */
+    overflow = half_select(bits > f32_infinity, 0x7e00, 0x7c00);
+
+    /* Denormal or zero, let the FPU do the rounding */
+    denormal = float_as_bits(bits_as_float(bits) + bits_as_float(denorm_magic)) - denorm_magic;
+
+    normal = (bits + ((uint32_t) (15 - 127) << 23) + 0xfff + ((bits >> 13) & 1)) >> 13;
+
+    bits = half_select(bits >= f16_max, overflow, half_select(bits < (113u << 23), denormal, normal));
+
+    return (uint16_t) (bits | sign >> 16);
+}
+
+inline static float
+bf16_to_float(uint16_t b)
+{
+    return bits_as_float((uint32_t) b << 16);
+}
+
+inline static uint16_t
+float_to_bf16(float f)
+{
+    uint32_t bits = float_as_bits(f);
+
+    /* Keep NaN quiet */
+    uint32_t nan = bits >> 16 | 0x40;
+    uint32_t rounded = (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+
+    return (uint16_t) half_select((bits & 0x7fffffffu) > 0x7f800000u, nan, rounded);
+}
+
+#endif //OPENSHMEM_COLLECTIVE_ROUTINES_HALF_H
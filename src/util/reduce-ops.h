@@ -0,0 +1,140 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#ifndef OPENSHMEM_COLLECTIVE_ROUTINES_REDUCE_OPS_H
+#define OPENSHMEM_COLLECTIVE_ROUTINES_REDUCE_OPS_H
+
+#include <stddef.h>
+
+#include "half.h"
+
+/*
+ * Local reduce helper, matches shcoll_reduce_op_t so that the generic
+ * engines can take it directly
+ */
+
+#define REDUCE_HELPER_LOCAL(_name, _type, _op)                  \
+    inline static void                                          \
+    local_##_name##_reduce(void *dest, const void *src1,        \
+                           const void *src2, size_t nreduce)    \
+    {                                                           \
+        _type *dest_array = dest;                               \
+        const _type *src1_array = src1;                         \
+        const _type *src2_array = src2;                         \
+        size_t i;                                               \
+                                                                \
+        for (i = 0; i < nreduce; i++) {                         \
+            dest_array[i] = _op(src1_array[i], src2_array[i]);  \
+        }                                                       \
+    }
+
+/*
+ * Supported reduction operations
+ */
+
+#define AND_OP(A, B)  ((A) & (B))
+#define MAX_OP(A, B)  ((A) > (B) ? (A) : (B))
+#define MIN_OP(A, B)  ((A) < (B) ? (A) : (B))
+#define SUM_OP(A, B)  ((A) + (B))
+#define PROD_OP(A, B) ((A) * (B))
+#define OR_OP(A, B)   ((A) | (B))
+#define XOR_OP(A, B)  ((A) ^ (B))
+
+/* 16-bit floating point values are combined in single precision */
+#define FP16_MAX_OP(A, B) (fp16_to_float(A) > fp16_to_float(B) ? (A) : (B))
+#define FP16_MIN_OP(A, B) (fp16_to_float(A) < fp16_to_float(B) ? (A) : (B))
+#define FP16_SUM_OP(A, B) float_to_fp16(fp16_to_float(A) + fp16_to_float(B))
+#define BF16_MAX_OP(A, B) (bf16_to_float(A) > bf16_to_float(B) ? (A) : (B))
+#define BF16_MIN_OP(A, B) (bf16_to_float(A) < bf16_to_float(B) ? (A) : (B))
+#define BF16_SUM_OP(A, B) float_to_bf16(bf16_to_float(A) + bf16_to_float(B))
+
+/* Ties are broken by the lowest index, so the result does not depend on the
+ * order in which the partial results are combined */
+#define MAXLOC_OP(A, B) ((A).val > (B).val ||                           \
+                         ((A).val == (B).val && (A).loc < (B).loc) ? (A) : (B))
+#define MINLOC_OP(A, B) ((A).val < (B).val ||                           \
+                         ((A).val == (B).val && (A).loc < (B).loc) ? (A) : (B))
+
+/*
+ * Definitions for all reductions
+ */
+
+#define SHCOLL_REDUCE_DEFINE(_name)                             \
+    /* AND operation */                                         \
+    _name(short_and,        short,      AND_OP)                 \
+        _name(int_and,          int,        AND_OP)             \
+        _name(long_and,         long,       AND_OP)             \
+        _name(longlong_and,     long long,  AND_OP)             \
+                                                                \
+        /* MAX operation */                                     \
+        _name(short_max,        short,          MAX_OP)         \
+        _name(int_max,          int,            MAX_OP)         \
+        _name(double_max,       double,         MAX_OP)         \
+        _name(float_max,        float,          MAX_OP)         \
+        _name(long_max,         long,           MAX_OP)         \
+        _name(longdouble_max,   long double,    MAX_OP)         \
+        _name(longlong_max,     long long,      MAX_OP)         \
+        _name(fp16_max,         shcoll_fp16_t,  FP16_MAX_OP)    \
+        _name(bf16_max,         shcoll_bf16_t,  BF16_MAX_OP)    \
+                                                                \
+        /* MIN operation */                                     \
+        _name(short_min,        short,          MIN_OP)         \
+        _name(int_min,          int,            MIN_OP)         \
+        _name(double_min,       double,         MIN_OP)         \
+        _name(float_min,        float,          MIN_OP)         \
+        _name(long_min,         long,           MIN_OP)         \
+        _name(longdouble_min,   long double,    MIN_OP)         \
+        _name(longlong_min,     long long,      MIN_OP)         \
+        _name(fp16_min,         shcoll_fp16_t,  FP16_MIN_OP)    \
+        _name(bf16_min,         shcoll_bf16_t,  BF16_MIN_OP)    \
+                                                                \
+        /* SUM operation */                                     \
+        _name(complexd_sum,     double _Complex,    SUM_OP)     \
+        _name(complexf_sum,     float _Complex,     SUM_OP)     \
+        _name(short_sum,        short,              SUM_OP)     \
+        _name(int_sum,          int,                SUM_OP)     \
+        _name(double_sum,       double,             SUM_OP)     \
+        _name(float_sum,        float,              SUM_OP)     \
+        _name(long_sum,         long,               SUM_OP)     \
+        _name(longdouble_sum,   long double,        SUM_OP)     \
+        _name(longlong_sum,     long long,          SUM_OP)     \
+        _name(fp16_sum,         shcoll_fp16_t,      FP16_SUM_OP) \
+        _name(bf16_sum,         shcoll_bf16_t,      BF16_SUM_OP) \
+                                                                \
+        /* PROD operation */                                    \
+        _name(complexd_prod,    double _Complex,    PROD_OP)    \
+        _name(complexf_prod,    float _Complex,     PROD_OP)    \
+        _name(short_prod,       short,              PROD_OP)    \
+        _name(int_prod,         int,                PROD_OP)    \
+        _name(double_prod,      double,             PROD_OP)    \
+        _name(float_prod,       float,              PROD_OP)    \
+        _name(long_prod,        long,               PROD_OP)    \
+        _name(longdouble_prod,  long double,        PROD_OP)    \
+        _name(longlong_prod,    long long,          PROD_OP)    \
+                                                                \
+        /* OR operation */                                      \
+        _name(short_or,         short,      OR_OP)              \
+        _name(int_or,           int,        OR_OP)              \
+        _name(long_or,          long,       OR_OP)              \
+        _name(longlong_or,      long long,  OR_OP)              \
+                                                                \
+        /* XOR operation */                                     \
+        _name(short_xor,        short,      XOR_OP)             \
+        _name(int_xor,          int,        XOR_OP)             \
+        _name(long_xor,         long,       XOR_OP)             \
+        _name(longlong_xor,     long long,  XOR_OP)             \
+                                                                \
+        /* MAXLOC operation */                                  \
+        _name(double_maxloc,    shcoll_double_int_t,    MAXLOC_OP) \
+        _name(float_maxloc,     shcoll_float_int_t,     MAXLOC_OP) \
+        _name(long_maxloc,      shcoll_long_int_t,      MAXLOC_OP) \
+        _name(int_maxloc,       shcoll_int_int_t,       MAXLOC_OP) \
+                                                                \
+        /* MINLOC operation */                                  \
+        _name(double_minloc,    shcoll_double_int_t,    MINLOC_OP) \
+        _name(float_minloc,     shcoll_float_int_t,     MINLOC_OP) \
+        _name(long_minloc,      shcoll_long_int_t,      MINLOC_OP) \
+        _name(int_minloc,       shcoll_int_int_t,       MINLOC_OP)
+
+#endif //OPENSHMEM_COLLECTIVE_ROUTINES_REDUCE_OPS_H
@@ -2,8 +2,7 @@
  * For license: see LICENSE file at top-level
  */
 
-#include <stdlib.h>
-#include <memory.h>
+#include <string.h>
 #include "rotate.h"
 
 static inline size_t
@@ -57,14 +56,65 @@ rotate_inplace(char *arr, size_t size, size_t dist)
     }
 }
 
+/*
+ * Rotation with a bounded stack buffer
+ *
+ * The part of the array that fits into the buffer is saved, the rest is moved
+ * with memmove and the saved part is copied back.  If neither part fits, the
+ * smaller part is swapped block-wise into its final place (Gries-Mills block
+ * swap) until it does.  All the moves are done with memcpy/memmove on large
+ * blocks, so they use the widest loads and stores available.
+ */
+
+#define ROTATE_BUFFER_SIZE 4096
+
+static inline void
+swap_blocks(char *a, char *b, size_t n, char *buf)
+{
+    size_t len;
+
+    for (; n > 0; n -= len, a += len, b += len) {
+        len = n < ROTATE_BUFFER_SIZE ? n : ROTATE_BUFFER_SIZE;
+
+        memcpy(buf, a, len);
+        memcpy(a, b, len);
+        memcpy(b, buf, len);
+    }
+}
+
 void
 rotate(char *arr, size_t size, size_t dist)
 {
-    char *tmp = malloc(dist);
+    char buf[ROTATE_BUFFER_SIZE];
+    size_t head;
+
+    if (dist == 0 || dist >= size) {
+        return;
+    }
 
-    memcpy(tmp, arr + (size - dist), dist);
-    memmove(arr + dist, arr, (size - dist));
-    memcpy(arr, tmp, dist);
+    /* The array is [head | tail] with tail of length dist, result is [tail | head] */
+    head = size - dist;
 
-    free(tmp);
+    while (head > ROTATE_BUFFER_SIZE && dist > ROTATE_BUFFER_SIZE) {
+        if (head >= dist) {
+            /* [h1 h2 | tail] -> [h1 tail | h2], h2 is in place */
+            swap_blocks(arr + head - dist, arr + head, dist, buf);
+            head -= dist;
+        } else {
+            /* [head | t1 t2] -> [t1 | head t2], t1 is in place */
+            swap_blocks(arr, arr + head, head, buf);
+            arr += head;
+            dist -= head;
+        }
+    }
+
+    if (dist <= ROTATE_BUFFER_SIZE) {
+        memcpy(buf, arr + head, dist);
+        memmove(arr + dist, arr, head);
+        memcpy(arr, buf, dist);
+    } else {
+        memcpy(buf, arr, head);
+        memmove(arr, arr + head, dist);
+        memcpy(arr + dist, buf, head);
+    }
 }
@@ -7,6 +7,12 @@
 
 #include <stddef.h>
 
+/*
+ * Both functions rotate arr right by dist bytes.  rotate_inplace moves single
+ * bytes along gcd cycles, rotate moves large blocks through a bounded stack
+ * buffer; neither allocates memory.
+ */
+
 void rotate_inplace(char *arr, size_t size, size_t dist);
 
 void rotate(char *arr, size_t size, size_t dist);
@@ -3,47 +3,136 @@
  */
 
 #include "../shcoll.h"
+#include "../shcoll/compat.h"
 #include "scan.h"
 
-void
-exclusive_prefix_sum(size_t *dest, size_t value, int PE_start, int logPE_stride, int PE_size, long *pSync)
+/*
+ * pSync[0] counts the acks of the messages sent, the next 2 * SCAN_MAX_ROUNDS
+ * slots receive the partial prefix and suffix sums (or flags) of each round,
+ * SCAN_MAX_ROUNDS rounds are enough for any PE_size.  A message is added to
+ * its slot as value + 1, and the receiver subtracts what it read instead of
+ * resetting the slot, so the atomics on a slot are ordered and pSync is back
+ * to SHCOLL_SYNC_VALUE on return without waiting for a reset to land.  Every
+ * slot has a single sender, which must not write it again before it is read:
+ * either the caller does not let any PE start the next call before all the
+ * PEs are done with this one, as the collect algorithms do, or the sender
+ * waits for the acks.
+ */
+#define SCAN_MAX_ROUNDS  ((PREFIX_SUM_SYNC_SIZE - 1) / 2)
+
+inline static void
+scan_slot_send(size_t *slot, size_t value, int pe)
+{
+    shmem_size_atomic_add(slot, value + 1, pe);
+}
+
+inline static size_t
+scan_slot_wait(size_t *slot, long *acks, int sender_pe)
+{
+    const int me = shmem_my_pe();
+    size_t received;
+
+    shmem_size_wait_until(slot, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+    received = *slot;
+    shmem_size_atomic_add(slot, SHCOLL_SYNC_VALUE - received, me);
+
+    if (acks != NULL) {
+        shmem_long_atomic_inc(acks, sender_pe);
+    }
+
+    return received - 1 - SHCOLL_SYNC_VALUE;
+}
+
+inline static void
+prefix_sum_helper(size_t *dest, size_t *total, size_t value, int PE_start, int logPE_stride, int PE_size,
+                  long *pSync, int ack)
 {
     const int stride = 1 << logPE_stride;
     const int me = shmem_my_pe();
     const int me_as = (me - PE_start) / stride;
 
-    size_t *scan_rounds = (size_t *) pSync;
-    size_t partial_scan = value;
-    int dist = 1;
-    int round = 0;
-    int parent;
-    int mask = 0x1;
+    long *acks = ack ? pSync : NULL;
+    size_t *prefix_rounds = (size_t *) (pSync + 1);
+    size_t *suffix_rounds = prefix_rounds + SCAN_MAX_ROUNDS;
+    size_t partial_prefix = value;
+    size_t partial_suffix = value;
+    long nsent = 0;
+    int dist;
+    int round;
 
-    parent = me_as + 1;
+    /* Both scans advance in the same rounds, the suffix one only if the
+     * total is needed: total = prefix + suffix - value */
+    for (dist = 1, round = 0; dist < PE_size; dist <<= 1, round++) {
+        if (me_as + dist < PE_size) {
+            scan_slot_send(prefix_rounds + round, partial_prefix, me + dist * stride);
+            nsent++;
+        }
 
-    if (parent < PE_size) {
-        shmem_size_atomic_add(scan_rounds, value + 1, parent);
-    }
+        if (total != NULL && me_as - dist >= 0) {
+            scan_slot_send(suffix_rounds + round, partial_suffix, me - dist * stride);
+            nsent++;
+        }
 
-    while (mask < PE_size) {
         if (me_as - dist >= 0) {
-            shmem_size_wait_until(&scan_rounds[round], SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
-            partial_scan += scan_rounds[round] - 1 - SHCOLL_SYNC_VALUE;
+            partial_prefix += scan_slot_wait(prefix_rounds + round, acks, me - dist * stride);
+        }
 
-            shmem_size_p(scan_rounds + round, SHCOLL_SYNC_VALUE, me);
-            shmem_size_wait_until(scan_rounds + round, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE);
+        if (total != NULL && me_as + dist < PE_size) {
+            partial_suffix += scan_slot_wait(suffix_rounds + round, acks, me + dist * stride);
         }
+    }
+
+    if (ack) {
+        shmem_long_wait_until(acks, SHMEM_CMP_EQ, SHCOLL_SYNC_VALUE + nsent);
+        shmem_long_atomic_add(acks, -nsent, me);
+    }
 
-        dist <<= 1;
-        round++;
+    *dest = partial_prefix - value;
 
-        parent = me_as + dist;
-        if (parent < PE_size) {
-            shmem_size_atomic_add(&scan_rounds[round], partial_scan + 1, parent);
-        }
+    if (total != NULL) {
+        *total = partial_prefix + partial_suffix - value;
+    }
+}
 
-        mask <<= 1;
+void
+exclusive_prefix_sum(size_t *dest, size_t *total, size_t value, int PE_start, int logPE_stride, int PE_size,
+                     long *pSync)
+{
+    prefix_sum_helper(dest, total, value, PE_start, logPE_stride, PE_size, pSync, 0);
+}
+
+void
+exclusive_prefix_sum_acked(size_t *dest, size_t *total, size_t value, int PE_start, int logPE_stride,
+                           int PE_size, long *pSync)
+{
+    prefix_sum_helper(dest, total, value, PE_start, logPE_stride, PE_size, pSync, 1);
+}
+
+size_t
+max_all(size_t value, int PE_start, int logPE_stride, int PE_size, long *pSync)
+{
+    const int stride = 1 << logPE_stride;
+    const int me = shmem_my_pe();
+    const int me_as = (me - PE_start) / stride;
+
+    size_t *rounds = (size_t *) (pSync + 1);
+    size_t result = value;
+    size_t received;
+    int dist;
+    int round;
+
+    /* Dissemination: after the last round every PE has heard from all */
+    for (dist = 1, round = 0; dist < PE_size; dist <<= 1, round++) {
+        scan_slot_send(rounds + round, result, PE_start + ((me_as + dist) % PE_size) * stride);
+        received = scan_slot_wait(rounds + round, NULL, -1);
+        result = received > result ? received : result;
     }
 
-    *dest = partial_scan - value;
+    return result;
+}
+
+int
+logical_or_all(int value, int PE_start, int logPE_stride, int PE_size, long *pSync)
+{
+    return max_all(value != 0, PE_start, logPE_stride, PE_size, pSync) != 0;
 }
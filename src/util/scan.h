@@ -7,10 +7,33 @@
 
 #include <stddef.h>
 
-/* TODO: move somewhere */
-#define PREFIX_SUM_SYNC_SIZE 32
+#include "../shcoll/common.h"     /* PREFIX_SUM_SYNC_SIZE */
 
+/*
+ * Exclusive prefix sum of value over the active set, total (if not NULL)
+ * gets the sum over all the PEs from the same recursive doubling pass.
+ * pSync is back to SHCOLL_SYNC_VALUE on return, but no PE may use it again
+ * before all the PEs are done with the call.
+ */
 /* TODO: maybe use size_t *pWrk instead of pSync */
-void exclusive_prefix_sum(size_t *dest, size_t value, int PE_start, int logPE_stride, int PE_size, long *pSync);
+void exclusive_prefix_sum(size_t *dest, size_t *total, size_t value, int PE_start, int logPE_stride, int PE_size,
+                          long *pSync);
+
+/*
+ * Same as exclusive_prefix_sum, but every message is acked and a PE returns
+ * only when its messages are read, so the PEs may leave the call at any time
+ * after it.  pSync[0] counts the acks.
+ */
+void exclusive_prefix_sum_acked(size_t *dest, size_t *total, size_t value, int PE_start, int logPE_stride,
+                                int PE_size, long *pSync);
+
+/*
+ * Maximum of value over the active set, with the same pSync layout, but only
+ * pSync[1..1+⌈log2(PE_size)⌉) are used
+ */
+size_t max_all(size_t value, int PE_start, int logPE_stride, int PE_size, long *pSync);
+
+/* Logical OR of value over the active set, as max_all */
+int logical_or_all(int value, int PE_start, int logPE_stride, int PE_size, long *pSync);
 
 #endif //OPENSHMEM_COLLECTIVE_ROUTINES_SCAN_H
@@ -25,6 +25,48 @@ static inline void shcoll_collect32_shmem(void *dest, const void *source, size_t
     shmem_collect32(dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
 }
 
+/* The plan outlives the tests, it is planned again when the count changes */
+static shcoll_collect_plan_t *collect_plan = NULL;
+
+static inline void shcoll_collect32_plan(void *dest, const void *source, size_t nelems, int PE_start,
+                                         int logPE_stride, int PE_size, long *pSync) {
+    if (collect_plan == NULL) {
+        collect_plan = shcoll_collect_plan_create(nelems * sizeof(uint32_t), PE_start, logPE_stride, PE_size, pSync);
+    }
+
+    shcoll_collect32_planned(collect_plan, dest, source, nelems, pSync);
+}
+
+/* Every call runs the next algorithm on the same pSync, which must be left
+ * at SHCOLL_SYNC_VALUE by each of them */
+static inline void shcoll_collect32_mixed(void *dest, const void *source, size_t nelems, int PE_start,
+                                          int logPE_stride, int PE_size, long *pSync) {
+    static const collect_impl any[] = {
+        shcoll_collect32_ring, shcoll_collect32_bidir_ring, shcoll_collect32_ring_segmented,
+        shcoll_collect32_rec_dbl_fold, shcoll_collect32_ring_no_scan, shcoll_collect32_bruck,
+        shcoll_collect32_bruck_no_rotate, shcoll_collect32_bruck_radix, shcoll_collect32_bruck_radix_no_rotate,
+        shcoll_collect32_bruck_radix_inplace, shcoll_collect32_all_linear, shcoll_collect32_all_linear1,
+    };
+    static const collect_impl pow2[] = {
+        shcoll_collect32_rec_dbl, shcoll_collect32_rec_dbl_signal, shcoll_collect32_rec_dbl_no_scan,
+    };
+    static const int nany = sizeof(any) / sizeof(any[0]);
+    static const int npow2 = sizeof(pow2) / sizeof(pow2[0]);
+    static int call = 0;
+
+    int i = call++ % (nany + npow2 + 1);
+
+    if (i < nany) {
+        any[i](dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    } else if (i < nany + npow2 && ((PE_size - 1) & PE_size) == 0) {
+        pow2[i - nany](dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    } else if (i == nany + npow2 && PE_size > 1) {
+        shcoll_collect32_linear(dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    } else {
+        any[0](dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    }
+}
+
 #ifdef EQUAL
 
 double test_collect32(collect_impl fcollect, int iterations, size_t nelem,
@@ -109,6 +151,15 @@ double test_collect32(collect_impl fcollect, int iterations, size_t nelem,
     shmem_barrier_all();
     unsigned long long end = current_time_ns();
 
+    #ifdef VERIFY
+    for (int i = 0; i < COLLECT_SYNC_SIZE; i++) {
+        if (pSync[i] != SYNC_VALUE) {
+            gprintf("[%d] pSync[%d] = %ld; Expected %ld\n", me, i, pSync[i], SYNC_VALUE);
+            abort();
+        }
+    }
+    #endif
+
     shmem_free(pSync);
     shmem_free(src);
     shmem_free(dst);
@@ -178,6 +229,15 @@ double test_collect32(collect_impl collect, int iterations, size_t count, long S
     shmem_barrier_all();
     unsigned long long end = current_time_ns();
 
+    #ifdef VERIFY
+    for (int i = 0; i < COLLECT_SYNC_SIZE; i++) {
+        if (pSync[i] != SYNC_VALUE) {
+            gprintf("[%d] pSync[%d] = %ld; Expected %ld\n", me, i, pSync[i], SYNC_VALUE);
+            abort();
+        }
+    }
+    #endif
+
     shmem_free(pSync);
     shmem_free(src);
     shmem_free(dst);
@@ -213,16 +273,38 @@ int main(int argc, char *argv[]) {
 
         RUN(collect32, shmem, iterations, count, SHMEM_SYNC_VALUE, SHMEM_COLLECT_SYNC_SIZE);
         RUNC(count >= 256, collect32, ring, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        RUN(collect32, bidir_ring, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+
+        /* Small segments, so that the blocks of the tests are split */
+        shcoll_set_collect_ring_segment_size(256);
+        RUN(collect32, ring_segmented, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+
         RUNC(!((npes - 1) & npes), collect32, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUNC(!((npes - 1) & npes), collect32, rec_dbl_signal, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        RUN(collect32, rec_dbl_fold, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        RUN(collect32, ring_no_scan, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        RUNC(!((npes - 1) & npes), collect32, rec_dbl_no_scan, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
 
         RUN(collect32, bruck, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUN(collect32, bruck_no_rotate, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        RUN(collect32, plan, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_PLANNED_SYNC_SIZE);
+
+        for (int k = 2; k <= 8; k *= 2) {
+            shcoll_set_collect_bruck_radix(k);
+            if (me == 0) gprintf("%d-", k);
+            RUN(collect32, bruck_radix, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+            if (me == 0) gprintf("%d-", k);
+            RUN(collect32, bruck_radix_no_rotate, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+            if (me == 0) gprintf("%d-", k);
+            RUN(collect32, bruck_radix_inplace, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        }
 
         RUNC(npes <= 16, collect32, linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUN(collect32, all_linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUN(collect32, all_linear1, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
 
+        RUN(collect32, mixed, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+
 
         if (me == 0) {
             #ifdef CSV
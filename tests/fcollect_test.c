@@ -26,6 +26,57 @@ static inline void shcoll_fcollect32_shmem(void *dest, const void *source, size_
     shmem_fcollect32(dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
 }
 
+/* Every call runs the next algorithm on the same pSync, which must be left
+ * at SHCOLL_SYNC_VALUE by each of them */
+static inline void shcoll_fcollect32_mixed(void *dest, const void *source, size_t nelems, int PE_start,
+                                           int logPE_stride, int PE_size, long *pSync) {
+    static const fcollect_impl any[] = {
+        shcoll_fcollect32_ring, shcoll_fcollect32_bidir_ring, shcoll_fcollect32_ring_segmented,
+        shcoll_fcollect32_rec_dbl_fold, shcoll_fcollect32_bruck, shcoll_fcollect32_bruck_no_rotate,
+        shcoll_fcollect32_bruck_signal, shcoll_fcollect32_bruck_radix, shcoll_fcollect32_bruck_radix_no_rotate,
+        shcoll_fcollect32_bruck_radix_inplace, shcoll_fcollect32_linear, shcoll_fcollect32_all_linear,
+        shcoll_fcollect32_all_linear1,
+    };
+    static const int nany = sizeof(any) / sizeof(any[0]);
+    static int call = 0;
+
+    int i = call++ % (nany + 2);
+
+    if (i < nany) {
+        any[i](dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    } else if (i == nany && PE_size % 2 == 0) {
+        shcoll_fcollect32_neighbor_exchange(dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    } else if (i == nany + 1 && ((PE_size - 1) & PE_size) == 0) {
+        shcoll_fcollect32_rec_dbl(dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    } else {
+        any[0](dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    }
+}
+
+/* Every call runs the algorithm twice with no barrier in between, the first
+ * time into another buffer, so a PE may already be in the second call while
+ * its peers are still in the first one */
+#define BACK_TO_BACK_WRAPPER(_name)                                                                             \
+    static inline void shcoll_fcollect32_back_to_back_##_name(void *dest, const void *source, size_t nelems,  \
+                                                              int PE_start, int logPE_stride, int PE_size,   \
+                                                              long *pSync) {                                 \
+        static uint32_t *other = NULL;                                                                          \
+        static size_t other_nelems = 0;                                                                         \
+                                                                                                                \
+        if (other_nelems < nelems * PE_size) {                                                                  \
+            shmem_free(other);                                                                                  \
+            other_nelems = nelems * PE_size;                                                                    \
+            other = shmem_malloc(other_nelems * sizeof(uint32_t));                                              \
+        }                                                                                                       \
+                                                                                                                \
+        shcoll_fcollect32_##_name(other, source, nelems, PE_start, logPE_stride, PE_size, pSync);              \
+        shcoll_fcollect32_##_name(dest, source, nelems, PE_start, logPE_stride, PE_size, pSync);               \
+    }
+
+BACK_TO_BACK_WRAPPER(bruck_radix)
+BACK_TO_BACK_WRAPPER(bruck_radix_no_rotate)
+BACK_TO_BACK_WRAPPER(bruck_radix_inplace)
+
 double test_fcollect32(fcollect_impl fcollect, int iterations, size_t nelem,
                        long SYNC_VALUE, size_t COLLECT_SYNC_SIZE) {
     long *pSync = shmem_malloc(COLLECT_SYNC_SIZE * sizeof(long));
@@ -99,6 +150,15 @@ double test_fcollect32(fcollect_impl fcollect, int iterations, size_t nelem,
     shmem_barrier_all();
     unsigned long long end = current_time_ns();
 
+    #ifdef VERIFY
+    for (int i = 0; i < COLLECT_SYNC_SIZE; i++) {
+        if (pSync[i] != SYNC_VALUE) {
+            gprintf("[%d] pSync[%d] = %ld; Expected %ld\n", me, i, pSync[i], SYNC_VALUE);
+            abort();
+        }
+    }
+    #endif
+
     shmem_free(pSync);
     shmem_free(src);
     shmem_free(dst);
@@ -131,18 +191,47 @@ int main(int argc, char *argv[]) {
         RUN(fcollect32, shmem, iterations, count, SHMEM_SYNC_VALUE, SHMEM_COLLECT_SYNC_SIZE);
 
         RUNC(count >= 256, fcollect32, ring, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        RUN(fcollect32, bidir_ring, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+
+        /* Small segments, so that the blocks of the tests are split */
+        shcoll_set_fcollect_ring_segment_size(256);
+        RUN(fcollect32, ring_segmented, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+
         RUNC(npes % 2 == 0 && count >= 32, fcollect32, neighbor_exchange, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUNC(!((npes - 1) & npes), fcollect32, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        RUN(fcollect32, rec_dbl_fold, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
 
         RUNC(count <= 256, fcollect32, bruck, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUNC(count <= 256, fcollect32, bruck_no_rotate, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUNC(count <= 256, fcollect32, bruck_signal, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUNC(0, fcollect32, bruck_inplace, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
 
+        for (int k = 2; k <= 8; k *= 2) {
+            shcoll_set_fcollect_bruck_radix(k);
+            if (me == 0) gprintf("%d-", k);
+            RUNC(count <= 256, fcollect32, bruck_radix, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+            if (me == 0) gprintf("%d-", k);
+            RUNC(count <= 256, fcollect32, bruck_radix_no_rotate, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+            if (me == 0) gprintf("%d-", k);
+            RUNC(count <= 256, fcollect32, bruck_radix_inplace, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        }
+
+        for (int k = 2; k <= 4; k++) {
+            shcoll_set_fcollect_bruck_radix(k);
+            if (me == 0) gprintf("%d-", k);
+            RUNC(count <= 256, fcollect32, back_to_back_bruck_radix, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+            if (me == 0) gprintf("%d-", k);
+            RUNC(count <= 256, fcollect32, back_to_back_bruck_radix_no_rotate, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+            if (me == 0) gprintf("%d-", k);
+            RUNC(count <= 256, fcollect32, back_to_back_bruck_radix_inplace, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+        }
+
         RUNC(npes <= 96, fcollect32, linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUNC(count <= 256, fcollect32, all_linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
         RUNC(count <= 256, fcollect32, all_linear1, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
 
+        RUN(fcollect32, mixed, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_COLLECT_SYNC_SIZE);
+
         if (me == 0) {
             #ifdef CSV
             gprintf("\n\n\n\n");
@@ -0,0 +1,153 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#include "gather.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "util/util.h"
+#include "util/debug.h"
+
+#define CSV
+#include "util/run.h"
+
+#define VERIFYx
+#define WARMUP
+
+typedef void (*gather_impl)(void *, const void *, size_t, int, int, int, int, long *);
+
+/* The gatherv variants are tested with count + me elements on PE me */
+double test_gather(gather_impl gather, int variable, int iterations, size_t count,
+                   long SYNC_VALUE, size_t GATHER_SYNC_SIZE) {
+    long *pSync = shmem_malloc(GATHER_SYNC_SIZE * sizeof(long));
+    for (int i = 0; i < GATHER_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+    int root = npes / 2;
+
+    size_t nelem = variable ? count + me : count;
+    size_t offset = variable ? me * count + (size_t) me * (me - 1) / 2 : me * count;
+    size_t total_nelem = variable ? npes * count + (size_t) npes * (npes - 1) / 2 : npes * count;
+
+    /* Symmetric allocations must have the same size on all the PEs */
+    uint32_t *src = shmem_malloc(total_nelem * sizeof(uint32_t));
+    uint32_t *dst = shmem_malloc(total_nelem * sizeof(uint32_t));
+
+    for (int i = 0; i < nelem; i++) {
+        src[i] = (uint32_t) (offset + i + 1);
+    }
+
+    #ifdef WARMUP
+    shmem_barrier_all();
+
+    for (int i = 0; i < iterations / 10; i++) {
+        shmem_barrier_all();
+        gather(dst, src, nelem, root, 0, 0, npes, pSync);
+    }
+    #endif
+
+    shmem_barrier_all();
+    time_ns_t start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        #ifdef VERIFY
+        memset(dst, 0, total_nelem * sizeof(uint32_t));
+        #endif
+
+        shmem_barrier_all();
+        gather(dst, src, nelem, root, 0, 0, npes, pSync);
+
+        #ifdef VERIFY
+        for (int j = 0; j < total_nelem && me == root; j++) {
+            if (dst[j] != j + 1) {
+                gprintf("[%d] i:%d dst[%d] = %u; Expected %u\n", me, i, j, dst[j], j + 1);
+                abort();
+            }
+        }
+        #endif
+    }
+
+    shmem_barrier_all();
+    time_ns_t end = current_time_ns();
+
+    #ifdef VERIFY
+    for (int i = 0; i < GATHER_SYNC_SIZE; i++) {
+        if (pSync[i] != SYNC_VALUE) {
+            gprintf("[%d] pSync[%d] = %ld; Expected %ld\n", me, i, pSync[i], SYNC_VALUE);
+            abort();
+        }
+    }
+    #endif
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(src);
+    shmem_free(dst);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+double test_gather32(gather_impl gather, int iterations, size_t count, long SYNC_VALUE, size_t GATHER_SYNC_SIZE) {
+    return test_gather(gather, 0, iterations, count, SYNC_VALUE, GATHER_SYNC_SIZE);
+}
+
+double test_gatherv32(gather_impl gather, int iterations, size_t count, long SYNC_VALUE, size_t GATHER_SYNC_SIZE) {
+    return test_gather(gather, 1, iterations, count, SYNC_VALUE, GATHER_SYNC_SIZE);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations;
+    size_t count;
+
+    time_ns_t start = current_time_ns();
+    shmem_init();
+    time_ns_t end = current_time_ns();
+
+    int me = shmem_my_pe();
+    int npes = shmem_n_pes();
+
+    if (me == 0) {
+        gprintf("%s PEs: %d; shmem_init: %lf\n", __FILE__, npes, (end - start) / 1e9);
+    }
+
+    // @formatter:off
+
+    for (int i = 1; i < argc; i++) {
+        sscanf(argv[i], "%d:%zu", &iterations, &count);
+
+        RUN(gather32, linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_GATHER_SYNC_SIZE);
+        RUN(gather32, binomial_tree, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_GATHER_SYNC_SIZE);
+
+        for (int radix = 2; radix <= 32; radix *= 2) {
+            shcoll_set_gather_knomial_tree_radix(radix);
+            if (me == 0) gprintf("%2d-", radix);
+            RUN(gather32, knomial_tree, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_GATHER_SYNC_SIZE);
+        }
+
+        if (me == 0) gprintf("\n");
+
+        RUN(gatherv32, linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_GATHER_SYNC_SIZE);
+        RUN(gatherv32, binomial_tree, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_GATHER_SYNC_SIZE);
+
+        for (int radix = 2; radix <= 32; radix *= 2) {
+            shcoll_set_gather_knomial_tree_radix(radix);
+            if (me == 0) gprintf("%2d-", radix);
+            RUN(gatherv32, knomial_tree, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_GATHER_SYNC_SIZE);
+        }
+
+        if (me == 0) {
+            gprintf("\n\n\n\n");
+        }
+    }
+
+    // @formatter:on
+
+    shmem_finalize();
+}
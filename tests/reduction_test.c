@@ -14,8 +14,17 @@
 #define PRINTx
 
 #define MAX(A, B) ((A) > (B) ? (A) : (B))
+#define MIN(A, B) ((A) < (B) ? (A) : (B))
 
 typedef void (*reduce_impl)(int *, const int *, int, int, int, int, int *, long *);
+typedef void (*float_reduce_impl)(float *, const float *, int, int, int, int, float *, long *);
+typedef void (*maxloc_reduce_impl)(shcoll_double_int_t *, const shcoll_double_int_t *, int, int, int, int,
+                                   shcoll_double_int_t *, long *);
+typedef void (*sparse_reduce_impl)(float *, const int *, const float *, int, int, int, int, int, int, float *, long *);
+typedef int (*sparse_pairs_reduce_impl)(int *, float *, const int *, const float *, int, int, int, int, int, float *, long *);
+typedef void (*batch_reduce_impl)(shcoll_reduce_batch_t *, int, int, int, long *);
+typedef void (*user_reduce_impl)(void *, const void *, int, size_t, shcoll_reduce_op_t, int, int, int, void *, long *);
+typedef void (*rooted_reduce_impl)(int *, const int *, int, int, int, int, int, int *, long *);
 
 static inline void shcoll_int_sum_to_all_shmem(int *dest, const int *source, int nreduce, int PE_start,
                                                int logPE_stride, int PE_size, int *pWrk, long *pSync) {
@@ -100,6 +109,640 @@ double test_int_sum_to_all(reduce_impl reduce, int iterations, size_t count,
     return (end - start) / 1e9;
 }
 
+#define IN_PLACE_WRAPPER(_name)                                                                                 \
+    static inline void shcoll_int_sum_in_place_##_name(int *dest, const int *source, int nreduce, int PE_start, \
+                                                       int logPE_stride, int PE_size, int *pWrk, long *pSync) { \
+        shcoll_int_sum_to_all_##_name(dest, source, nreduce, PE_start, logPE_stride, PE_size, pWrk, pSync);     \
+    }
+
+IN_PLACE_WRAPPER(linear)
+IN_PLACE_WRAPPER(rec_dbl)
+IN_PLACE_WRAPPER(rabenseifner)
+IN_PLACE_WRAPPER(rabenseifner2)
+
+double test_int_sum_in_place(reduce_impl reduce, int iterations, size_t count,
+                             long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    int *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, count) * sizeof(int));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    int *buf = shmem_calloc(count, sizeof(int));
+    int sum = (npes + 1) * npes / 2;
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        /* The source is overwritten by the result */
+        for (int j = 0; j < count; j++) {
+            buf[j] = ((j + 1) % 10007) * (me + 1);
+        }
+
+        shmem_barrier_all();
+        reduce(buf, buf, (int) count, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        for (int j = 0; j < count; j++) {
+            if (buf[j] != sum * ((j + 1) % 10007)) {
+                gprintf("[%d] i:%d buf[%d] = %d; Expected %d\n", me, i, j, buf[j], sum * ((j + 1) % 10007));
+                abort();
+            }
+        }
+        #endif
+    }
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(buf);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+
+double test_float_sum_to_all(float_reduce_impl reduce, int iterations, size_t count, float tolerance,
+                             long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    float *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, count) * sizeof(float));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    float *dst = shmem_calloc(count, sizeof(float));
+    float *src = shmem_calloc(count, sizeof(float));
+
+    for (int i = 0; i < count; i++) {
+        src[i] = ((i + 1) % 7) * (me + 1) * 0.25f;
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        #ifdef VERIFY
+        memset(dst, 0, count * sizeof(float));
+        #endif
+
+        shmem_barrier_all();
+        reduce(dst, src, (int) count, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        float sum = (npes + 1) * npes / 2 * 0.25f;
+        for (int j = 0; j < count; j++) {
+            float expected = sum * ((j + 1) % 7);
+            if (dst[j] < expected * (1 - tolerance) || dst[j] > expected * (1 + tolerance)) {
+                gprintf("[%d] i:%d dst[%d] = %f; Expected %f\n", me, i, j, dst[j], expected);
+                abort();
+            }
+        }
+        #endif
+    }
+
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(src);
+    shmem_free(dst);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+
+double test_double_maxloc_to_all(maxloc_reduce_impl reduce, int iterations, size_t count,
+                                 long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    shcoll_double_int_t *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, count) * sizeof(shcoll_double_int_t));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    shcoll_double_int_t *dst = shmem_calloc(count, sizeof(shcoll_double_int_t));
+    shcoll_double_int_t *src = shmem_calloc(count, sizeof(shcoll_double_int_t));
+
+    /* Every value appears on several PEs, the lowest PE index wins */
+    for (int i = 0; i < count; i++) {
+        src[i].val = (double) ((i + me) % 3);
+        src[i].loc = me;
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        #ifdef VERIFY
+        memset(dst, 0, count * sizeof(shcoll_double_int_t));
+        #endif
+
+        shmem_barrier_all();
+        reduce(dst, src, (int) count, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        for (int j = 0; j < count; j++) {
+            double max = -1;
+            int loc = -1;
+
+            for (int pe = 0; pe < npes; pe++) {
+                if ((j + pe) % 3 > max) {
+                    max = (j + pe) % 3;
+                    loc = pe;
+                }
+            }
+
+            if (dst[j].val != max || dst[j].loc != loc) {
+                gprintf("[%d] i:%d dst[%d] = {%f, %d}; Expected {%f, %d}\n",
+                        me, i, j, dst[j].val, dst[j].loc, max, loc);
+                abort();
+            }
+        }
+        #endif
+    }
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(src);
+    shmem_free(dst);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+static inline void shcoll_float_sum_sparse_merge(float *dest, const int *indices, const float *values, int nnz,
+                                                 int nreduce, int max_nnz, int PE_start, int logPE_stride,
+                                                 int PE_size, float *pWrk, long *pSync) {
+    shcoll_set_reduce_sparse_density(1.0);
+    shcoll_float_sum_to_all_sparse(dest, indices, values, nnz, nreduce, max_nnz, PE_start, logPE_stride, PE_size,
+                                   pWrk, pSync);
+}
+
+static inline void shcoll_float_sum_sparse_dense(float *dest, const int *indices, const float *values, int nnz,
+                                                 int nreduce, int max_nnz, int PE_start, int logPE_stride,
+                                                 int PE_size, float *pWrk, long *pSync) {
+    shcoll_set_reduce_sparse_density(0.0);
+    shcoll_float_sum_to_all_sparse(dest, indices, values, nnz, nreduce, max_nnz, PE_start, logPE_stride, PE_size,
+                                   pWrk, pSync);
+}
+
+double test_float_sum_sparse(sparse_reduce_impl reduce, int iterations, size_t count,
+                             long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    /* About 1% of the elements on each PE, with duplicates */
+    int nnz = (int) (count / 100 + 1);
+    int max_nnz = (int) MIN(count, (size_t) nnz * npes);
+
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    float *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, SHCOLL_REDUCE_SPARSE_WRKDATA_SIZE(float, max_nnz)) *
+                               sizeof(float));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    float *dst = shmem_calloc(count, sizeof(float));
+    float *expected = calloc(count, sizeof(float));
+    int *indices = calloc(nnz, sizeof(int));
+    float *values = calloc(nnz, sizeof(float));
+
+    for (int pe = 0; pe < npes; pe++) {
+        for (int k = 0; k < nnz; k++) {
+            int index = (int) ((pe * 7 + k * 13) % count);
+            float value = (float) (pe + 1);
+
+            expected[index] += value;
+            if (pe == me) {
+                indices[k] = index;
+                values[k] = value;
+            }
+        }
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        #ifdef VERIFY
+        for (int j = 0; j < count; j++) {
+            dst[j] = -1;
+        }
+        #endif
+
+        shmem_barrier_all();
+        reduce(dst, indices, values, nnz, (int) count, max_nnz, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        for (int j = 0; j < count; j++) {
+            if (dst[j] != expected[j]) {
+                gprintf("[%d] i:%d dst[%d] = %f; Expected %f\n", me, i, j, dst[j], expected[j]);
+                abort();
+            }
+        }
+        #endif
+    }
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(dst);
+    free(expected);
+    free(indices);
+    free(values);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+double test_float_sum_to_all_sparse(sparse_pairs_reduce_impl reduce, int iterations, size_t count,
+                                    long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    /* Same pairs as test_float_sum_sparse */
+    int nnz = (int) (count / 100 + 1);
+    int max_nnz = (int) MIN(count, (size_t) nnz * npes);
+
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    float *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, SHCOLL_REDUCE_SPARSE_WRKDATA_SIZE(float, max_nnz)) *
+                               sizeof(float));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    float *expected = calloc(count, sizeof(float));
+    int *indices = calloc(nnz, sizeof(int));
+    float *values = calloc(nnz, sizeof(float));
+    int *dst_indices = calloc(max_nnz, sizeof(int));
+    float *dst_values = calloc(max_nnz, sizeof(float));
+    int expected_nnz = 0;
+
+    for (int pe = 0; pe < npes; pe++) {
+        for (int k = 0; k < nnz; k++) {
+            int index = (int) ((pe * 7 + k * 13) % count);
+            float value = (float) (pe + 1);
+
+            expected_nnz += expected[index] == 0;
+            expected[index] += value;
+            if (pe == me) {
+                indices[k] = index;
+                values[k] = value;
+            }
+        }
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        shmem_barrier_all();
+        int dst_nnz = reduce(dst_indices, dst_values, indices, values, nnz, max_nnz, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        if (dst_nnz != expected_nnz) {
+            gprintf("[%d] i:%d nnz = %d; Expected %d\n", me, i, dst_nnz, expected_nnz);
+            abort();
+        }
+
+        for (int j = 0; j < dst_nnz; j++) {
+            if ((j > 0 && dst_indices[j] <= dst_indices[j - 1]) || dst_values[j] != expected[dst_indices[j]]) {
+                gprintf("[%d] i:%d (%d, %f); Expected %f\n", me, i, dst_indices[j], dst_values[j],
+                        expected[dst_indices[j]]);
+                abort();
+            }
+        }
+        #endif
+    }
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    free(expected);
+    free(indices);
+    free(values);
+    free(dst_indices);
+    free(dst_values);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+double test_reduce_batch(batch_reduce_impl reduce, int iterations, size_t count,
+                         long SYNC_VALUE, size_t REDUCE_SYNC_SIZE) {
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    shcoll_reduce_batch_t *batch = shcoll_reduce_batch_create(
+            count * (sizeof(int) + sizeof(double) + sizeof(shcoll_long_int_t)) + 64);
+
+    /* Three reductions of different types and operators in one batch */
+    int *int_dst = calloc(count, sizeof(int));
+    int *int_src = calloc(count, sizeof(int));
+    double *double_dst = calloc(count, sizeof(double));
+    double *double_src = calloc(count, sizeof(double));
+    shcoll_long_int_t *loc_dst = calloc(count, sizeof(shcoll_long_int_t));
+    shcoll_long_int_t *loc_src = calloc(count, sizeof(shcoll_long_int_t));
+
+    for (int i = 0; i < count; i++) {
+        int_src[i] = ((i + 1) % 10007) * (me + 1);
+        double_src[i] = (double) ((i + me) % npes);
+        loc_src[i].val = (long) ((i + me) % npes);
+        loc_src[i].loc = me;
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        #ifdef VERIFY
+        memset(int_dst, 0, count * sizeof(int));
+        memset(double_dst, 0, count * sizeof(double));
+        memset(loc_dst, 0, count * sizeof(shcoll_long_int_t));
+        #endif
+
+        shmem_barrier_all();
+        shcoll_reduce_batch_begin(batch);
+        shcoll_reduce_batch_add_int_sum(batch, int_dst, int_src, (int) count);
+        shcoll_reduce_batch_add_double_max(batch, double_dst, double_src, (int) count);
+        shcoll_reduce_batch_add_long_minloc(batch, loc_dst, loc_src, (int) count);
+        reduce(batch, 0, 0, npes, pSync);
+
+        #ifdef VERIFY
+        int sum = (npes + 1) * npes / 2;
+        for (int j = 0; j < count; j++) {
+            if (int_dst[j] != sum * ((j + 1) % 10007) || double_dst[j] != npes - 1 ||
+                loc_dst[j].val != 0 || loc_dst[j].loc != (npes - j % npes) % npes) {
+                gprintf("[%d] i:%d dst[%d] = {%d, %f, {%ld, %d}}; Expected {%d, %f, {%d, %d}}\n",
+                        me, i, j, int_dst[j], double_dst[j], loc_dst[j].val, loc_dst[j].loc,
+                        sum * ((j + 1) % 10007), (double) (npes - 1), 0, (npes - j % npes) % npes);
+                abort();
+            }
+        }
+        #endif
+    }
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shcoll_reduce_batch_destroy(batch);
+    shmem_free(pSync);
+    free(int_src);
+    free(int_dst);
+    free(double_src);
+    free(double_dst);
+    free(loc_src);
+    free(loc_dst);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+typedef struct {
+    int min;
+    int max;
+} min_max_t;
+
+static void min_max_op(void *dest, const void *src1, const void *src2, size_t nelems) {
+    min_max_t *d = dest;
+    const min_max_t *a = src1;
+    const min_max_t *b = src2;
+
+    for (size_t i = 0; i < nelems; i++) {
+        int min = a[i].min < b[i].min ? a[i].min : b[i].min;
+        int max = a[i].max > b[i].max ? a[i].max : b[i].max;
+        d[i].min = min;
+        d[i].max = max;
+    }
+}
+
+double test_reduce_user_to_all(user_reduce_impl reduce, int iterations, size_t count,
+                               long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    min_max_t *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, count) * sizeof(min_max_t));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    min_max_t *dst = shmem_calloc(count, sizeof(min_max_t));
+    min_max_t *src = shmem_calloc(count, sizeof(min_max_t));
+
+    for (int i = 0; i < count; i++) {
+        src[i].min = src[i].max = (int) ((i + me) % npes);
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        #ifdef VERIFY
+        memset(dst, 0, count * sizeof(min_max_t));
+        #endif
+
+        shmem_barrier_all();
+        reduce(dst, src, (int) count, sizeof(min_max_t), min_max_op, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        for (int j = 0; j < count; j++) {
+            if (dst[j].min != 0 || dst[j].max != npes - 1) {
+                gprintf("[%d] i:%d dst[%d] = {%d, %d}; Expected {%d, %d}\n",
+                        me, i, j, dst[j].min, dst[j].max, 0, npes - 1);
+                abort();
+            }
+        }
+        #endif
+    }
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(src);
+    shmem_free(dst);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+
+double test_int_sum_reduce(rooted_reduce_impl reduce, int iterations, size_t count,
+                           long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    int *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, count) * sizeof(int));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    int *dst = shmem_calloc(count, sizeof(int));
+    int *src = shmem_calloc(count, sizeof(int));
+
+    for (int i = 0; i < count; i++) {
+        src[i] = ((i + 1) % 10007) * (me + 1);
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        int root = i % npes;
+
+        #ifdef VERIFY
+        memset(dst, 0, count * sizeof(uint32_t));
+        #endif
+
+        shmem_barrier_all();
+        reduce(dst, src, (int) count, root, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        if (me == root) {
+            int sum = (npes + 1) * npes / 2;
+            for (int j = 0; j < count; j++) {
+                if (dst[j] != sum * ((j + 1) % 10007)) {
+                    gprintf("[%d] i:%d dst[%d] = %d; Expected %d\n", me, i, j, dst[j], sum * ((j + 1) % 10007));
+                    abort();
+                }
+            }
+        }
+        #endif
+    }
+
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(src);
+    shmem_free(dst);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+
+#define ROOTED_IN_PLACE_WRAPPER(_name)                                                                          \
+    static inline void shcoll_int_sum_reduce_in_place_##_name(int *dest, const int *source, int nreduce,     \
+                                                              int PE_root, int PE_start, int logPE_stride,  \
+                                                              int PE_size, int *pWrk, long *pSync) {        \
+        shcoll_int_sum_reduce_##_name(dest, source, nreduce, PE_root, PE_start, logPE_stride, PE_size,      \
+                                      pWrk, pSync);                                                         \
+    }
+
+ROOTED_IN_PLACE_WRAPPER(binomial)
+ROOTED_IN_PLACE_WRAPPER(knomial)
+ROOTED_IN_PLACE_WRAPPER(rabenseifner)
+
+double test_int_sum_reduce_in_place(rooted_reduce_impl reduce, int iterations, size_t count,
+                                    long SYNC_VALUE, size_t REDUCE_SYNC_SIZE, size_t REDUCE_MIN_WRKDATA_SIZE) {
+    long *pSync = shmem_malloc(REDUCE_SYNC_SIZE * sizeof(long));
+    int *pWrk = shmem_malloc(MAX(REDUCE_MIN_WRKDATA_SIZE, count) * sizeof(int));
+
+    for (int i = 0; i < REDUCE_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int npes = shmem_n_pes();
+    int me = shmem_my_pe();
+
+    int *buf = shmem_calloc(count, sizeof(int));
+    int sum = (npes + 1) * npes / 2;
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        int root = i % npes;
+
+        /* The source is overwritten by the result on the root */
+        for (int j = 0; j < count; j++) {
+            buf[j] = ((j + 1) % 10007) * (me + 1);
+        }
+
+        shmem_barrier_all();
+        reduce(buf, buf, (int) count, root, 0, 0, npes, pWrk, pSync);
+
+        #ifdef VERIFY
+        if (me == root) {
+            for (int j = 0; j < count; j++) {
+                if (buf[j] != sum * ((j + 1) % 10007)) {
+                    gprintf("[%d] i:%d buf[%d] = %d; Expected %d\n", me, i, j, buf[j], sum * ((j + 1) % 10007));
+                    abort();
+                }
+            }
+        }
+        #endif
+    }
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(buf);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
 
 int main(int argc, char *argv[]) {
     int iterations = argc > 1 ? (int) strtol(argv[1], NULL, 0) : 1;
@@ -115,9 +758,79 @@ int main(int argc, char *argv[]) {
 
     RUN(int_sum_to_all, shmem, iterations, count, SHMEM_SYNC_VALUE, SHMEM_REDUCE_SYNC_SIZE, SHMEM_REDUCE_MIN_WRKDATA_SIZE);
     RUN(int_sum_to_all, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    for (int k = 2; k <= 32; k *= 2) {
+        shcoll_set_reduce_rec_mult_radix(k);
+        if (shmem_my_pe() == 0) gprintf("%2d-", k);
+        RUN(int_sum_to_all, rec_mult, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    }
+
     RUN(int_sum_to_all, binomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    for (int k = 2; k <= 32; k *= 2) {
+        shcoll_set_reduce_knomial_tree_radix(k);
+        if (shmem_my_pe() == 0) gprintf("%2d-", k);
+        RUN(int_sum_to_all, knomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    }
+
+    /* Node size 0 is detected with shmem_ptr */
+    for (int s = 0; s <= 4; s++) {
+        shcoll_set_reduce_node_size(s);
+        if (shmem_my_pe() == 0) gprintf("%2d-", s);
+        RUN(int_sum_to_all, hierarchical, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_HIERARCHICAL_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    }
+
     RUN(int_sum_to_all, rabenseifner, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    shcoll_set_reduce_threads(4);
+    if (shmem_my_pe() == 0) gprintf("threads-");
+    RUN(int_sum_to_all, rabenseifner, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    if (shmem_my_pe() == 0) gprintf("threads-");
+    RUN(int_sum_to_all, rabenseifner2, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    shcoll_set_reduce_threads(1);
+
     RUN(int_sum_to_all, linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_to_all, atomic, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_to_all, binomial_pipelined, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_to_all, knomial_pipelined, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    RUN(int_sum_in_place, linear, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_in_place, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_in_place, rabenseifner, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_in_place, rabenseifner2, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    RUN(float_sum_to_all, rabenseifner, iterations, count, 1e-6, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(float_sum_to_all, rabenseifner_fp16, iterations, count, 1e-2, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(float_sum_to_all, rabenseifner_bf16, iterations, count, 5e-2, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(float_sum_to_all, rabenseifner2_fp16, iterations, count, 1e-2, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(float_sum_to_all, rabenseifner2_bf16, iterations, count, 5e-2, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    RUN(double_maxloc_to_all, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(double_maxloc_to_all, rabenseifner, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(double_maxloc_to_all, knomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    RUN(float_sum_sparse, merge, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SPARSE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(float_sum_sparse, dense, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SPARSE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(float_sum_to_all_sparse, pairs, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SPARSE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    RUN(reduce_batch, end, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE);
+
+    RUN(reduce_user_to_all, binomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(reduce_user_to_all, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(reduce_user_to_all, rabenseifner, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    RUN(int_sum_reduce, binomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    for (int k = 2; k <= 32; k *= 2) {
+        shcoll_set_reduce_knomial_tree_radix(k);
+        if (shmem_my_pe() == 0) gprintf("%2d-", k);
+        RUN(int_sum_reduce, knomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    }
+
+    RUN(int_sum_reduce, rabenseifner, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+
+    RUN(int_sum_reduce_in_place, binomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_reduce_in_place, knomial, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
+    RUN(int_sum_reduce_in_place, rabenseifner, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_REDUCE_SYNC_SIZE, SHCOLL_REDUCE_MIN_WRKDATA_SIZE);
 
     // @formatter:on
 
@@ -0,0 +1,87 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "util/util.h"
+#include "util/debug.h"
+#include "util/run.h"
+#include "util/rotate.h"
+
+#define VERIFY
+
+#define shcoll_rotate_block_swap rotate
+#define shcoll_rotate_gcd_cycles rotate_inplace
+
+typedef void (*rotate_impl)(char *, size_t, size_t);
+
+/* Rotates a local array by every distance used by a Bruck allgather on npes PEs */
+double test_rotate(rotate_impl rotate_func, int iterations, size_t size, int npes) {
+    size_t nbytes = size / npes;
+    char *arr = malloc(size);
+    int me = shmem_my_pe();
+
+    for (size_t i = 0; i < size; i++) {
+        arr[i] = (char) (i % 251);
+    }
+
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 1; j < npes; j++) {
+            rotate_func(arr, size, j * nbytes);
+        }
+    }
+
+    unsigned long long end = current_time_ns();
+
+    #ifdef VERIFY
+    /* Overall rotation is iterations * nbytes * (npes - 1) * npes / 2 */
+    size_t dist = (size_t) ((unsigned long long) iterations * nbytes * (npes - 1) * npes / 2 % size);
+    for (size_t i = 0; i < size; i++) {
+        char expected = (char) ((i + size - dist) % size % 251);
+        if (arr[i] != expected) {
+            gprintf("[%d] size:%zu arr[%zu] = %d; Expected %d\n", me, size, i, arr[i], expected);
+            abort();
+        }
+    }
+    #endif
+
+    free(arr);
+
+    return (end - start) / 1e9;
+}
+
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? (int) strtol(argv[1], NULL, 0) : 1;
+    int npes = argc > 2 ? (int) strtol(argv[2], NULL, 0) : 16;
+    size_t size;
+
+    shmem_init();
+
+    if (shmem_my_pe() == 0) {
+        gprintf("[%s]PEs: %d; blocks: %d\n", __FILE__, shmem_n_pes(), npes);
+    }
+
+    // @formatter:off
+
+    /* Sizes are chosen so that the blocks are not a multiple of the buffer size */
+    for (size = 1000; size <= 10000000; size *= 10) {
+        if (shmem_my_pe() == 0) {
+            gprintf("%zu-", size);
+        }
+        RUN(rotate, block_swap, iterations, size, npes);
+
+        if (shmem_my_pe() == 0) {
+            gprintf("%zu-", size);
+        }
+        RUN(rotate, gcd_cycles, iterations, size, npes);
+    }
+
+    // @formatter:on
+
+    shmem_finalize();
+}
@@ -0,0 +1,105 @@
+/*
+ * For license: see LICENSE file at top-level
+ */
+
+#include "scan.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "util/util.h"
+#include "util/debug.h"
+#include "util/run.h"
+
+#define VERIFY
+
+#define MAX(A, B) ((A) > (B) ? (A) : (B))
+
+typedef void (*scan_impl)(long *, const long *, int, int, int, int, long *, long *);
+
+double test_scan(scan_impl scan, int exclusive, int iterations, size_t count,
+                 long SYNC_VALUE, size_t SCAN_SYNC_SIZE) {
+    long *pSync = shmem_malloc(SCAN_SYNC_SIZE * sizeof(long));
+    long *pWrk = shmem_malloc(MAX(SHCOLL_REDUCE_MIN_WRKDATA_SIZE, count) * sizeof(long));
+
+    for (int i = 0; i < SCAN_SYNC_SIZE; i++) {
+        pSync[i] = SYNC_VALUE;
+    }
+
+    shmem_barrier_all();
+
+    int me = shmem_my_pe();
+
+    long *dst = shmem_calloc(count, sizeof(long));
+    long *src = shmem_calloc(count, sizeof(long));
+
+    for (int i = 0; i < count; i++) {
+        src[i] = ((i + 1) % 10007) * (me + 1);
+    }
+
+    shmem_barrier_all();
+    unsigned long long start = current_time_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        #ifdef VERIFY
+        memset(dst, 0, count * sizeof(long));
+        #endif
+
+        shmem_barrier_all();
+        scan(dst, src, (int) count, 0, 0, shmem_n_pes(), pWrk, pSync);
+
+        #ifdef VERIFY
+        long n = exclusive ? me : me + 1;
+        long sum = (n + 1) * n / 2;
+        for (int j = 0; j < count && (!exclusive || me != 0); j++) {
+            if (dst[j] != sum * ((j + 1) % 10007)) {
+                gprintf("[%d] i:%d dst[%d] = %ld; Expected %ld\n", me, i, j, dst[j], sum * ((j + 1) % 10007));
+                abort();
+            }
+        }
+        #endif
+    }
+
+
+    unsigned long long end = current_time_ns();
+
+    shmem_barrier_all();
+    shmem_free(pSync);
+    shmem_free(pWrk);
+    shmem_free(src);
+    shmem_free(dst);
+    shmem_barrier_all();
+
+    return (end - start) / 1e9;
+}
+
+double test_long_sum_scan(scan_impl scan, int iterations, size_t count, long SYNC_VALUE, size_t SCAN_SYNC_SIZE) {
+    return test_scan(scan, 0, iterations, count, SYNC_VALUE, SCAN_SYNC_SIZE);
+}
+
+double test_long_sum_exscan(scan_impl scan, int iterations, size_t count, long SYNC_VALUE, size_t SCAN_SYNC_SIZE) {
+    return test_scan(scan, 1, iterations, count, SYNC_VALUE, SCAN_SYNC_SIZE);
+}
+
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? (int) strtol(argv[1], NULL, 0) : 1;
+    size_t count = argc > 2 ? (size_t) strtol(argv[2], NULL, 0) : 1;
+
+    shmem_init();
+
+    if (shmem_my_pe() == 0) {
+        gprintf("[%s]PEs: %d; size: %zu bytes\n", __FILE__, shmem_n_pes(), count * sizeof(long));
+    }
+
+    // @formatter:off
+
+    RUN(long_sum_scan, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_SCAN_SYNC_SIZE);
+    RUN(long_sum_scan, up_down_sweep, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_SCAN_SYNC_SIZE);
+
+    RUN(long_sum_exscan, rec_dbl, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_SCAN_SYNC_SIZE);
+    RUN(long_sum_exscan, up_down_sweep, iterations, count, SHCOLL_SYNC_VALUE, SHCOLL_SCAN_SYNC_SIZE);
+
+    // @formatter:on
+
+    shmem_finalize();
+}